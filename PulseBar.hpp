@@ -1,21 +1,61 @@
 #pragma once
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <charconv>
 #include <chrono>
+#include <cerrno>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
+#include <vector>
 #if defined(_WIN32) || defined(_WIN64)
+#include <fcntl.h>
+#include <io.h>
 #include <windows.h>
 #define OS_WINDOWS
 #else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 #endif
 
+// USDT 静态探针（provider 为 pulsebar），可用 perf/bpftrace 在不重新编译的情况下观测：
+//   update(id, now, total)、frame_build(id, bytes, ns)、write(bytes, ns)、
+//   create(id, total)、complete(id, now, elapsed_ns)
+// 未挂载时每个探针只是一条 nop；没有 <sys/sdt.h> 或定义了 PULSEBAR_NO_PROBES 时编译为空
+#if !defined(PULSEBAR_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PULSE_HAS_PROBES 1
+#endif
+#endif
+#ifdef PULSE_HAS_PROBES
+#define PULSE_PROBE2(name, a1, a2) DTRACE_PROBE2(pulsebar, name, a1, a2)
+#define PULSE_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(pulsebar, name, a1, a2, a3)
+#else
+#define PULSE_PROBE2(name, a1, a2) ((void) 0)
+#define PULSE_PROBE3(name, a1, a2, a3) ((void) 0)
+#endif
+
 namespace pulse {
     // 颜色枚举
     enum class ColorType {
@@ -43,6 +83,8 @@ namespace pulse {
     public:
         virtual ~AnimationStrategy() = default;
         virtual const char *getCurrentFrame(double elapsed_time, int percent) const = 0;
+        // 相邻两帧的时间间隔（秒）；0 表示未知，每次刷新都需重绘；无穷大表示静止不变
+        virtual double frameInterval() const { return 0.0; }
     };
 
     // 默认动画
@@ -53,6 +95,8 @@ namespace pulse {
             int pulse_idx = static_cast<int>(elapsed_time * 15) % 14;
             return pulses[pulse_idx];
         }
+
+        double frameInterval() const override { return 1.0 / 15; }
     };
 
     // 实心块动画
@@ -61,30 +105,41 @@ namespace pulse {
         const char *getCurrentFrame(double elapsed_time, int percent) const override {
             return "█";// 固定使用实心块
         }
+
+        double frameInterval() const override { return std::numeric_limits<double>::infinity(); }
     } inline solidBlockAnimation;
 
     // 颜色工具类
     class ColorUtils {
     public:
+        static constexpr std::string_view getAnsiCodeView(ColorType type) {
+            switch (type) {
+                case ColorType::RED: return "\033[31m";
+                case ColorType::GREEN: return "\033[32m";
+                case ColorType::YELLOW: return "\033[33m";
+                case ColorType::BLUE: return "\033[34m";
+                case ColorType::MAGENTA: return "\033[35m";
+                case ColorType::CYAN: return "\033[36m";
+                case ColorType::WHITE: return "\033[37m";
+                case ColorType::GRAY: return "\033[90m";
+                case ColorType::BRIGHT_RED: return "\033[1;31m";
+                case ColorType::BRIGHT_GREEN: return "\033[1;32m";
+                case ColorType::BRIGHT_YELLOW: return "\033[1;33m";
+                case ColorType::BRIGHT_BLUE: return "\033[1;34m";
+                case ColorType::BRIGHT_MAGENTA: return "\033[1;35m";
+                case ColorType::BRIGHT_CYAN: return "\033[1;36m";
+                case ColorType::BRIGHT_WHITE: return "\033[1;37m";
+                case ColorType::RESET: return "\033[0m";
+                default: return {};
+            }
+        }
+
         static std::string getAnsiCode(ColorType type) {
-            static const std::unordered_map<ColorType, std::string> colorMap = {
-                    {ColorType::RED, "\033[31m"},
-                    {ColorType::GREEN, "\033[32m"},
-                    {ColorType::YELLOW, "\033[33m"},
-                    {ColorType::BLUE, "\033[34m"},
-                    {ColorType::MAGENTA, "\033[35m"},
-                    {ColorType::CYAN, "\033[36m"},
-                    {ColorType::WHITE, "\033[37m"},
-                    {ColorType::GRAY, "\033[90m"},
-                    {ColorType::BRIGHT_RED, "\033[1;31m"},
-                    {ColorType::BRIGHT_GREEN, "\033[1;32m"},
-                    {ColorType::BRIGHT_YELLOW, "\033[1;33m"},
-                    {ColorType::BRIGHT_BLUE, "\033[1;34m"},
-                    {ColorType::BRIGHT_MAGENTA, "\033[1;35m"},
-                    {ColorType::BRIGHT_CYAN, "\033[1;36m"},
-                    {ColorType::BRIGHT_WHITE, "\033[1;37m"},
-                    {ColorType::RESET, "\033[0m"}};
-            return colorMap.at(type);
+            std::string_view code = getAnsiCodeView(type);
+            if (code.empty()) {
+                throw std::out_of_range("Color type has no fixed ANSI code");
+            }
+            return std::string(code);
         }
 
         static std::string getAnsiCode(const std::string &hexColor) {
@@ -98,11 +153,995 @@ namespace pulse {
         }
     };
 
+    // 主题策略接口：负责渲染括号之间的进度条主体
+    class ThemeStrategy {
+    public:
+        virtual ~ThemeStrategy() = default;
+        virtual int width() const = 0;
+        virtual void renderBody(std::string &out, int filled, const char *glyph) const = 0;
+    };
+
+    namespace detail {
+        inline constexpr std::string_view kBlockGlyph = "█";
+
+        // FNV-1a 64 位哈希
+        constexpr std::uint64_t fnv1a64(std::string_view bytes) {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (char c: bytes) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        // 不超过 limit 字节的最长前缀长度，只在 UTF-8 码点边界截断
+        constexpr std::size_t utf8PrefixLength(std::string_view text, std::size_t limit) {
+            if (text.size() <= limit) return text.size();
+            std::size_t len = limit;
+            while (len > 0 && (static_cast<unsigned char>(text[len]) & 0xC0) == 0x80) --len;
+            return len;
+        }
+
+        // 主题中第 i 格的颜色，颜色列表沿宽度均匀分布
+        template<int Width, ColorType... Colors>
+        constexpr ColorType themeColorAt(int i) {
+            constexpr ColorType colors[] = {Colors...};
+            return colors[static_cast<std::size_t>(i) * sizeof...(Colors) / Width];
+        }
+
+        template<int Width, ColorType... Colors>
+        constexpr std::size_t themeLevelLength(int filled) {
+            std::size_t len = 0;
+            for (int i = 0; i < filled; ++i) {
+                if (i == 0 || themeColorAt<Width, Colors...>(i) != themeColorAt<Width, Colors...>(i - 1)) {
+                    len += ColorUtils::getAnsiCodeView(themeColorAt<Width, Colors...>(i)).size();
+                }
+                len += kBlockGlyph.size();
+            }
+            return len + ColorUtils::getAnsiCodeView(ColorType::RESET).size() + static_cast<std::size_t>(Width - filled);
+        }
+
+        // 每个填充级别一行，定长存放，另记录有效长度与动画格的偏移
+        template<int Width, std::size_t Stride>
+        struct ThemeTable {
+            static constexpr std::size_t stride = Stride;
+            std::array<char, (Width + 1) * Stride> bytes{};
+            std::array<std::uint32_t, Width + 1> length{};
+            std::array<std::uint32_t, Width + 1> glyph_offset{};
+        };
+
+        template<int Width, ColorType... Colors>
+        constexpr auto buildThemeTable() {
+            constexpr std::size_t stride = themeLevelLength<Width, Colors...>(Width);
+            ThemeTable<Width, stride> table{};
+            auto copy = [&table](std::size_t &pos, std::string_view src) {
+                for (char c: src) table.bytes[pos++] = c;
+            };
+            for (int filled = 0; filled <= Width; ++filled) {
+                const std::size_t start = static_cast<std::size_t>(filled) * stride;
+                std::size_t pos = start;
+                for (int i = 0; i < filled; ++i) {
+                    ColorType color = themeColorAt<Width, Colors...>(i);
+                    if (i == 0 || color != themeColorAt<Width, Colors...>(i - 1)) {
+                        copy(pos, ColorUtils::getAnsiCodeView(color));
+                    }
+                    if (i == filled - 1) {
+                        table.glyph_offset[filled] = static_cast<std::uint32_t>(pos - start);
+                    }
+                    copy(pos, kBlockGlyph);
+                }
+                copy(pos, ColorUtils::getAnsiCodeView(ColorType::RESET));
+                for (int i = filled; i < Width; ++i) table.bytes[pos++] = ' ';
+                table.length[filled] = static_cast<std::uint32_t>(pos - start);
+            }
+            return table;
+        }
+    }// namespace detail
+
+    // 编译期预渲染主题：宽度与颜色固定时，每个填充级别的字节序列在编译期生成，
+    // 渲染时只需拷贝对应的一行并替换动画格
+    template<int Width, ColorType... Colors>
+    class StaticTheme : public ThemeStrategy {
+        static_assert(Width > 0, "StaticTheme width must be positive");
+        static_assert(sizeof...(Colors) > 0, "StaticTheme needs at least one color");
+        static_assert(((!ColorUtils::getAnsiCodeView(Colors).empty()) && ...), "StaticTheme colors need fixed ANSI codes");
+
+    public:
+        static constexpr auto table = detail::buildThemeTable<Width, Colors...>();
+
+        int width() const override { return Width; }
+
+        void renderBody(std::string &out, int filled, const char *glyph) const override {
+            filled = std::clamp(filled, 0, Width);
+            const char *row = table.bytes.data() + static_cast<std::size_t>(filled) * table.stride;
+            const std::size_t len = table.length[filled];
+            if (filled == 0) {
+                out.append(row, len);
+                return;
+            }
+            const std::size_t offset = table.glyph_offset[filled];
+            const std::size_t tail = offset + detail::kBlockGlyph.size();
+            out.append(row, offset);
+            out.append(glyph);
+            out.append(row + tail, len - tail);
+        }
+    };
+
+    // 输出目标接口，所有进度条共享同一个输出目标
+    class OutputSink {
+    public:
+        virtual ~OutputSink() = default;
+        virtual void write(const char *data, std::size_t size) = 0;
+        virtual void flush() {}
+    };
+
+    // 文件描述符输出：先写入内部缓冲，flush 时直接调用 write(2)
+    class FdSink : public OutputSink {
+    public:
+        explicit FdSink(int fd, std::size_t capacity = 4096)
+            : fd_(fd), buffer_(capacity) {}
+
+        ~FdSink() override {
+            flush();
+        }
+
+        void write(const char *data, std::size_t size) override {
+            if (used_ + size > buffer_.size()) flush();
+            if (size >= buffer_.size()) {
+                writeAll(data, size);
+                return;
+            }
+            std::memcpy(buffer_.data() + used_, data, size);
+            used_ += size;
+        }
+
+        void flush() override {
+            if (used_ == 0) return;
+            writeAll(buffer_.data(), used_);
+            used_ = 0;
+        }
+
+        int fd() const { return fd_; }
+
+    protected:
+        void writeAll(const char *data, std::size_t size) {
+            while (size > 0) {
+#ifdef OS_WINDOWS
+                int n = ::_write(fd_, data, static_cast<unsigned>(size));
+#else
+                ssize_t n = ::write(fd_, data, size);
+#endif
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    return;// 输出失败时丢弃，进度显示不应影响任务本身
+                }
+                data += n;
+                size -= static_cast<std::size_t>(n);
+            }
+        }
+
+        int fd_;
+        std::vector<char> buffer_;
+        std::size_t used_ = 0;
+    };
+
+    // C 标准库 FILE* 输出
+    class FileSink : public OutputSink {
+    public:
+        explicit FileSink(std::FILE *file) : file_(file) {}
+
+        void write(const char *data, std::size_t size) override {
+            std::fwrite(data, 1, size, file_);
+        }
+
+        void flush() override {
+            std::fflush(file_);
+        }
+
+    private:
+        std::FILE *file_;
+    };
+
+    // std::ostream 输出，兼容旧的 std::cout 行为
+    class OstreamSink : public OutputSink {
+    public:
+        explicit OstreamSink(std::ostream &os) : os_(os) {}
+
+        void write(const char *data, std::size_t size) override {
+            os_.write(data, static_cast<std::streamsize>(size));
+        }
+
+        void flush() override {
+            os_.flush();
+        }
+
+    private:
+        std::ostream &os_;
+    };
+
+    // 控制终端输出：直接打开 /dev/tty，不与 stdout/stderr 上的数据流交错；打开失败时退回 stderr
+    class TtySink : public FdSink {
+    public:
+        TtySink() : FdSink(openTty()) {
+            owns_fd_ = fd_ >= 0;
+            if (!owns_fd_) fd_ = stderrFd();
+        }
+
+        ~TtySink() override {
+            flush();
+            if (owns_fd_) {
+#ifdef OS_WINDOWS
+                ::_close(fd_);
+#else
+                ::close(fd_);
+#endif
+            }
+        }
+
+        bool isControllingTty() const { return owns_fd_; }
+
+    private:
+        static int openTty() {
+#ifdef OS_WINDOWS
+            return ::_open("CONOUT$", _O_WRONLY);
+#else
+            return ::open("/dev/tty", O_WRONLY | O_CLOEXEC | O_NOCTTY);
+#endif
+        }
+
+        static int stderrFd() {
+#ifdef OS_WINDOWS
+            return _fileno(stderr);
+#else
+            return STDERR_FILENO;
+#endif
+        }
+
+        bool owns_fd_ = false;
+    };
+
+    // 速率估计策略接口：按固定采样周期喂入 (时间, 计数) 样本，给出每秒迭代数，0 表示尚无估计
+    class RateEstimator {
+    public:
+        virtual ~RateEstimator() = default;
+        virtual void reset() = 0;
+        virtual void addSample(double time, double count) = 0;
+        virtual double rate() const = 0;
+        // 用先验速度（如历史记录）作为尚无样本时的初始估计
+        virtual void seed(double /*rate*/) {}
+    };
+
+    // 指数移动平均（对每次迭代耗时做平滑）
+    class EmaRateEstimator : public RateEstimator {
+    public:
+        explicit EmaRateEstimator(float smoothing = 0.3f) { setSmoothing(smoothing); }
+
+        // 平滑系数，越大越偏向最近的样本
+        void setSmoothing(float smoothing) { smoothing_ = std::clamp(smoothing, 0.0f, 1.0f); }
+        float smoothing() const { return smoothing_; }
+
+        void reset() override {
+            has_last_ = false;
+            avg_time_ = 0.0;
+        }
+
+        void addSample(double time, double count) override {
+            if (has_last_) {
+                double delta_t = time - last_time_;
+                double delta_it = count - last_count_;
+                // 没有新进度时保留上一个样本，下一次有进度时覆盖整个区间
+                if (delta_it == 0 || delta_t <= 0) return;
+                if (delta_it > 0) {
+                    double current_rate = delta_t / delta_it;
+                    if (avg_time_ == 0.0) {
+                        avg_time_ = current_rate;
+                    } else {
+                        avg_time_ = smoothing_ * current_rate + (1 - smoothing_) * avg_time_;
+                    }
+                }
+            }
+            last_time_ = time;
+            last_count_ = count;
+            has_last_ = true;
+        }
+
+        double rate() const override { return avg_time_ > 0.0 ? 1.0 / avg_time_ : 0.0; }
+
+        void seed(double rate) override {
+            if (avg_time_ == 0.0 && rate > 0.0) avg_time_ = 1.0 / rate;
+        }
+
+    private:
+        float smoothing_ = 0.3f;
+        double avg_time_ = 0.0;
+        double last_time_ = 0.0;
+        double last_count_ = 0.0;
+        bool has_last_ = false;
+    };
+
+    // 固定窗口滑动速率：环形缓冲保存最近 N 个样本，速率为窗口首尾的差分，O(1)
+    class SlidingWindowRateEstimator : public RateEstimator {
+    public:
+        explicit SlidingWindowRateEstimator(std::size_t window = 32)
+            : samples_(std::max<std::size_t>(window, 2)) {}
+
+        void reset() override {
+            head_ = 0;
+            size_ = 0;
+        }
+
+        void addSample(double time, double count) override {
+            samples_[head_] = {time, count};
+            head_ = (head_ + 1) % samples_.size();
+            if (size_ < samples_.size()) ++size_;
+        }
+
+        double rate() const override {
+            if (size_ < 2) return 0.0;
+            const Sample &newest = samples_[(head_ + samples_.size() - 1) % samples_.size()];
+            const Sample &oldest = samples_[(head_ + samples_.size() - size_) % samples_.size()];
+            double delta_t = newest.time - oldest.time;
+            return delta_t > 0.0 ? std::max(0.0, (newest.count - oldest.count) / delta_t) : 0.0;
+        }
+
+    private:
+        struct Sample {
+            double time;
+            double count;
+        };
+        std::vector<Sample> samples_;
+        std::size_t head_ = 0;
+        std::size_t size_ = 0;
+    };
+
+    // Holt 双指数平滑：同时跟踪速率的水平与趋势，适合持续加速或减速的任务
+    class HoltRateEstimator : public RateEstimator {
+    public:
+        explicit HoltRateEstimator(double alpha = 0.3, double beta = 0.1)
+            : alpha_(std::clamp(alpha, 0.0, 1.0)), beta_(std::clamp(beta, 0.0, 1.0)) {}
+
+        void reset() override {
+            has_last_ = false;
+            has_level_ = false;
+            level_ = 0.0;
+            trend_ = 0.0;
+        }
+
+        void addSample(double time, double count) override {
+            if (has_last_) {
+                double delta_t = time - last_time_;
+                if (delta_t <= 0) return;
+                double current_rate = (count - last_count_) / delta_t;
+                if (!has_level_) {
+                    level_ = current_rate;
+                    has_level_ = true;
+                } else {
+                    double previous_level = level_;
+                    level_ = alpha_ * current_rate + (1 - alpha_) * (level_ + trend_);
+                    trend_ = beta_ * (level_ - previous_level) + (1 - beta_) * trend_;
+                }
+            }
+            last_time_ = time;
+            last_count_ = count;
+            has_last_ = true;
+        }
+
+        double rate() const override { return has_level_ ? std::max(0.0, level_ + trend_) : 0.0; }
+
+        void seed(double rate) override {
+            if (has_level_ || rate <= 0.0) return;
+            level_ = rate;
+            has_level_ = true;
+        }
+
+    private:
+        double alpha_;
+        double beta_;
+        double level_ = 0.0;
+        double trend_ = 0.0;
+        double last_time_ = 0.0;
+        double last_count_ = 0.0;
+        bool has_last_ = false;
+        bool has_level_ = false;
+    };
+
+    // 全程平均速率
+    class AverageRateEstimator : public RateEstimator {
+    public:
+        void reset() override { has_first_ = false; }
+
+        void addSample(double time, double count) override {
+            if (!has_first_) {
+                first_time_ = time;
+                first_count_ = count;
+                has_first_ = true;
+            }
+            last_time_ = time;
+            last_count_ = count;
+        }
+
+        double rate() const override {
+            double delta_t = last_time_ - first_time_;
+            return has_first_ && delta_t > 0.0 ? std::max(0.0, (last_count_ - first_count_) / delta_t) : 0.0;
+        }
+
+    private:
+        double first_time_ = 0.0;
+        double first_count_ = 0.0;
+        double last_time_ = 0.0;
+        double last_count_ = 0.0;
+        bool has_first_ = false;
+    };
+
+    namespace detail {
+        // 每个线程固定分配一个分片编号，用于把并发写入分散到不同缓存行
+        inline std::size_t threadShard() {
+            static std::atomic<std::size_t> next_shard{0};
+            thread_local std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed);
+            return shard;
+        }
+
+        // 按线程分片的计数器：多线程同时累加时互不争用缓存行，读取时求和
+        class ShardedCounter {
+        public:
+            static constexpr std::size_t kShards = 16;
+
+            void add(std::uint64_t n = 1) {
+                cells_[threadShard() % kShards].value.fetch_add(n, std::memory_order_relaxed);
+            }
+
+            std::uint64_t load() const {
+                std::uint64_t sum = 0;
+                for (const Cell &cell: cells_) sum += cell.value.load(std::memory_order_relaxed);
+                return sum;
+            }
+
+        private:
+            struct alignas(64) Cell {
+                std::atomic<std::uint64_t> value{0};
+            };
+            std::array<Cell, kShards> cells_{};
+        };
+
+        // 计算 a * b / c（向下取整），中间结果不经过浮点，10^13 量级的计数仍然精确
+        constexpr std::uint64_t mulDiv(std::uint64_t a, std::uint64_t b, std::uint64_t c) {
+#ifdef __SIZEOF_INT128__
+            return static_cast<std::uint64_t>(static_cast<unsigned __int128>(a) * b / c);
+#else
+            // a = q*c + r，b 为百分比或宽度这类小数时 r*b 不会溢出
+            return (a / c) * b + (a % c) * b / c;
+#endif
+        }
+
+        // 计算 a * b / c（向上取整）
+        constexpr std::uint64_t mulDivCeil(std::uint64_t a, std::uint64_t b, std::uint64_t c) {
+#ifdef __SIZEOF_INT128__
+            return static_cast<std::uint64_t>((static_cast<unsigned __int128>(a) * b + c - 1) / c);
+#else
+            return mulDiv(a, b, c) + ((a % c) * b % c != 0 ? 1 : 0);
+#endif
+        }
+
+        inline std::int64_t toNanos(std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+        }
+
+        // 追加十进制整数，不经过临时字符串
+        inline void appendInt(std::string &out, std::int64_t value) {
+            char buf[24];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            out.append(buf, result.ptr);
+        }
+
+        // 将纳秒格式化为带单位的短字符串追加到 out
+        inline void appendDuration(std::string &out, double ns) {
+            static const char *units[] = {"ns", "us", "ms", "s"};
+            int unit = 0;
+            while (unit < 3 && ns >= 1000.0) {
+                ns /= 1000.0;
+                ++unit;
+            }
+            char buf[32];
+            int len = std::snprintf(buf, sizeof(buf), unit == 0 ? "%.0f%s" : "%.3g%s", ns, units[unit]);
+            out.append(buf, static_cast<std::size_t>(std::clamp(len, 0, static_cast<int>(sizeof(buf)) - 1)));
+        }
+
+        inline std::string formatDuration(double ns) {
+            std::string out;
+            appendDuration(out, ns);
+            return out;
+        }
+    }// namespace detail
+
+    // 单位缩放方式：不缩放、SI（1000 进制：k/M/G）、IEC（1024 进制：Ki/Mi/Gi）
+    enum class UnitScale {
+        NONE,
+        SI,
+        IEC
+    };
+
+    // 速度显示方式：每秒单位数、每单位秒数，或速度低于 1 时自动切换为后者
+    enum class RateDisplay {
+        UNITS_PER_SECOND,
+        SECONDS_PER_UNIT,
+        AUTO
+    };
+
+    namespace detail {
+        // 按缩放方式格式化数值并附加单位，如 12.34MiB，追加到 out
+        inline void appendScaled(std::string &out, double value, UnitScale scale, std::string_view unit) {
+            static const char *si_prefixes[] = {"", "k", "M", "G", "T", "P", "E"};
+            static const char *iec_prefixes[] = {"", "Ki", "Mi", "Gi", "Ti", "Pi", "Ei"};
+            const char *prefix = "";
+            if (scale != UnitScale::NONE) {
+                const double base = scale == UnitScale::SI ? 1000.0 : 1024.0;
+                const char **prefixes = scale == UnitScale::SI ? si_prefixes : iec_prefixes;
+                int level = 0;
+                while (level < 6 && std::fabs(value) >= base) {
+                    value /= base;
+                    ++level;
+                }
+                prefix = prefixes[level];
+            }
+            char buf[48];
+            int len = std::snprintf(buf, sizeof(buf), "%.2f%s", value, prefix);
+            out.append(buf, static_cast<std::size_t>(std::clamp(len, 0, static_cast<int>(sizeof(buf)) - 1)));
+            out += unit;
+        }
+    }// namespace detail
+
+    // 对数分桶的延迟直方图（HDR 风格）：每个 2 的幂区间再分 8 个子桶，相对误差不超过 12.5%。
+    // 按线程分片，记录只是一次无竞争的 relaxed 原子加
+    class LatencyHistogram {
+    public:
+        static constexpr int kSubBucketBits = 3;
+        static constexpr int kSubBuckets = 1 << kSubBucketBits;
+        static constexpr int kBucketCount = (64 - kSubBucketBits + 1) * kSubBuckets;
+        static constexpr std::size_t kShards = 16;
+
+        void record(std::uint64_t ns) {
+            Shard &shard = shards_[detail::threadShard() % kShards];
+            shard.buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void reset() {
+            for (Shard &shard: shards_) {
+                for (auto &bucket: shard.buckets) bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // 合并所有分片的快照
+        struct Snapshot {
+            std::array<std::uint64_t, kBucketCount> buckets{};
+            std::uint64_t count = 0;
+
+            // 第 p 百分位（0~100）的纳秒值，取所在桶的中点
+            double percentile(double p) const {
+                if (count == 0) return 0.0;
+                auto rank = static_cast<std::uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * count));
+                rank = std::max<std::uint64_t>(rank, 1);
+                std::uint64_t seen = 0;
+                for (int i = 0; i < kBucketCount; ++i) {
+                    seen += buckets[i];
+                    if (seen >= rank) return bucketMidpoint(i);
+                }
+                return bucketMidpoint(kBucketCount - 1);
+            }
+        };
+
+        Snapshot snapshot() const {
+            Snapshot snap;
+            for (const Shard &shard: shards_) {
+                for (int i = 0; i < kBucketCount; ++i) {
+                    snap.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+                }
+            }
+            for (std::uint64_t n: snap.buckets) snap.count += n;
+            return snap;
+        }
+
+        static int bucketIndex(std::uint64_t ns) {
+            if (ns < kSubBuckets) return static_cast<int>(ns);
+            int shift = std::bit_width(ns) - 1 - kSubBucketBits;
+            return shift * kSubBuckets + static_cast<int>(ns >> shift);
+        }
+
+        static double bucketMidpoint(int index) {
+            if (index < kSubBuckets) return index;
+            int shift = index / kSubBuckets - 1;
+            double lower = std::ldexp(index - shift * kSubBuckets, shift);
+            return lower + std::ldexp(1.0, shift) / 2;
+        }
+
+    private:
+        struct alignas(64) Shard {
+            std::array<std::atomic<std::uint64_t>, kBucketCount> buckets{};
+        };
+        std::array<Shard, kShards> shards_{};
+    };
+
+    // 历史运行记录：内存映射的定长环形文件，按 key 保存过往运行的总量、耗时与进度曲线，
+    // 用于让新的运行从一开始就有可靠的 ETA，并发现明显慢于历史的运行
+    class HistoryStore {
+    public:
+        static constexpr std::size_t kCurvePoints = 16;
+        static constexpr std::uint32_t kCapacity = 256;
+
+        struct Record {
+            std::uint64_t key;            // key 的哈希
+            std::uint64_t total;          // 总量
+            double duration;              // 总耗时（秒）
+            float curve[kCurvePoints];    // curve[i]：完成 (i+1)/16 时的耗时占总耗时的比例
+            char label[40];               // 便于查看的 key 前缀
+        };
+        static_assert(sizeof(Record) == 128, "HistoryStore::Record layout must stay fixed");
+
+        explicit HistoryStore(const std::string &path) : path_(path) {
+            open();
+        }
+
+        ~HistoryStore() {
+#ifndef OS_WINDOWS
+            if (data_) ::munmap(data_, kFileSize);
+            if (fd_ >= 0) ::close(fd_);
+#endif
+        }
+
+        HistoryStore(const HistoryStore &) = delete;
+        HistoryStore &operator=(const HistoryStore &) = delete;
+
+        bool isOpen() const { return data_ != nullptr; }
+
+        // 查找 key 最近一次的记录，优先选择总量相同的记录
+        bool find(std::string_view key, std::uint64_t total, Record &out) const {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!data_) return false;
+            FileLock file_lock(fd_, false);
+            const std::uint64_t hash = detail::fnv1a64(key);
+            const std::uint64_t next = header()->next;
+            const std::uint64_t count = std::min<std::uint64_t>(next, kCapacity);
+            const Record *fallback = nullptr;
+            for (std::uint64_t i = 1; i <= count; ++i) {
+                const Record &rec = records()[(next - i) % kCapacity];
+                if (rec.key != hash || rec.duration <= 0.0) continue;
+                if (rec.total == total) {
+                    out = rec;
+                    return true;
+                }
+                if (!fallback) fallback = &rec;
+            }
+            if (!fallback) return false;
+            out = *fallback;
+            return true;
+        }
+
+        void append(std::string_view key, std::uint64_t total, double duration, const float (&curve)[kCurvePoints]) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!data_) return;
+            FileLock file_lock(fd_, true);
+            Record &rec = records()[header()->next % kCapacity];
+            rec.key = detail::fnv1a64(key);
+            rec.total = total;
+            rec.duration = duration;
+            std::copy(std::begin(curve), std::end(curve), rec.curve);
+            std::memset(rec.label, 0, sizeof(rec.label));
+            std::memcpy(rec.label, key.data(), detail::utf8PrefixLength(key, sizeof(rec.label) - 1));
+            ++header()->next;
+#ifdef OS_WINDOWS
+            save();
+#endif
+        }
+
+    private:
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t capacity;
+            std::uint64_t next;// 下一条记录的序号，取模得到槽位
+            char reserved[40];
+        };
+        static_assert(sizeof(Header) == 64, "HistoryStore::Header layout must stay fixed");
+
+        static constexpr char kMagic[8] = {'P', 'B', 'H', 'I', 'S', 'T', '1', '\0'};
+        static constexpr std::size_t kFileSize = sizeof(Header) + kCapacity * sizeof(Record);
+
+        // 文件被多个进程同时映射（例如并行的夜间任务），mtx_ 只在进程内互斥；
+        // 初始化与追加另外持有整个文件的 flock 排它锁，读取持有共享锁
+        class FileLock {
+        public:
+            FileLock(int fd, bool exclusive) : fd_(fd) {
+#ifndef OS_WINDOWS
+                if (fd_ >= 0) {
+                    while (::flock(fd_, exclusive ? LOCK_EX : LOCK_SH) != 0 && errno == EINTR) {
+                    }
+                }
+#else
+                (void) exclusive;
+#endif
+            }
+            ~FileLock() {
+#ifndef OS_WINDOWS
+                if (fd_ >= 0) ::flock(fd_, LOCK_UN);
+#endif
+            }
+            FileLock(const FileLock &) = delete;
+            FileLock &operator=(const FileLock &) = delete;
+
+        private:
+            int fd_;
+        };
+
+        Header *header() const { return reinterpret_cast<Header *>(data_); }
+        Record *records() const { return reinterpret_cast<Record *>(static_cast<char *>(data_) + sizeof(Header)); }
+
+        void open() {
+#ifdef OS_WINDOWS
+            buffer_.assign(kFileSize, 0);
+            if (std::FILE *file = std::fopen(path_.c_str(), "rb")) {
+                std::fread(buffer_.data(), 1, buffer_.size(), file);
+                std::fclose(file);
+            }
+            data_ = buffer_.data();
+            initialize();
+#else
+            int fd = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0) return;
+            {
+                FileLock file_lock(fd, true);
+                struct stat st {};
+                void *map = MAP_FAILED;
+                if (::fstat(fd, &st) == 0 && (static_cast<std::size_t>(st.st_size) >= kFileSize || ::ftruncate(fd, kFileSize) == 0)) {
+                    map = ::mmap(nullptr, kFileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                }
+                if (map != MAP_FAILED) {
+                    data_ = map;
+                    fd_ = fd;
+                    initialize();
+                }
+            }
+            if (fd_ < 0) ::close(fd);
+#endif
+        }
+
+        // 新文件或格式不符时重新初始化；调用方持有文件锁
+        void initialize() {
+            Header *h = header();
+            if (std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 || h->version != 1 || h->capacity != kCapacity) {
+                std::memset(data_, 0, kFileSize);
+                std::memcpy(h->magic, kMagic, sizeof(kMagic));
+                h->version = 1;
+                h->capacity = kCapacity;
+            }
+        }
+
+#ifdef OS_WINDOWS
+        void save() {
+            if (std::FILE *file = std::fopen(path_.c_str(), "wb")) {
+                std::fwrite(buffer_.data(), 1, buffer_.size(), file);
+                std::fclose(file);
+            }
+        }
+
+        std::vector<char> buffer_;
+#endif
+        std::string path_;
+        void *data_ = nullptr;
+        int fd_ = -1;
+        mutable std::mutex mtx_;
+    };
+
     // 进度条配置回调类型
     using BracketCallback = std::function<std::pair<std::string, std::string>(int percent)>;
     using ColorBlendCallback = std::function<ColorType(int position, int width, int percent)>;
     using TimeFormatCallback = std::function<std::string(double elapsed_time, bool is_completed)>;
 
+    class PulseBar;
+    class BarObserver;
+
+    // 时钟接口：ETA、速度、刷新节流与看门狗都从这里取时间，测试与基准可注入手动时钟。
+    // 自身开销统计（构建、写出、等锁耗时）始终使用真实时钟
+    class ClockSource {
+    public:
+        virtual ~ClockSource() = default;
+        virtual std::chrono::steady_clock::time_point now() const = 0;
+    };
+
+    // 单个进度条自身的开销统计
+    struct BarStats {
+        std::uint64_t id = 0;
+        std::string label;
+        std::uint64_t update_calls = 0;     // update()/advance()/operator++ 调用次数，需开启更新计数
+        std::uint64_t frames_built = 0;     // 构建的行数
+        std::uint64_t frames_written = 0;   // 写出的行数（不含与上一帧相同而跳过的行）
+        std::uint64_t bytes_written = 0;    // 写出的行占用的字节，含光标移动与清行序列
+        std::uint64_t build_ns = 0;         // 构建耗时
+        std::uint64_t lock_wait_ns = 0;     // 更新时等待全局锁的时间
+        std::uint64_t throttled_updates = 0;// 未触发绘制的更新
+    };
+
+    // 全局开销统计，计数包含已完成或已销毁的进度条
+    struct OverheadStats {
+        std::uint64_t update_calls = 0;
+        std::uint64_t frames_built = 0;
+        std::uint64_t frames_written = 0;
+        std::uint64_t bytes_written = 0;
+        std::uint64_t build_ns = 0;
+        std::uint64_t write_ns = 0;
+        std::uint64_t lock_wait_ns = 0;
+        std::uint64_t lock_contentions = 0;// 需要等待全局锁的次数
+        std::uint64_t throttled_updates = 0;
+        std::uint64_t deduped_writes = 0;
+        std::vector<BarStats> bars;// 当前存活的进度条
+    };
+
+    OverheadStats stats();
+
+    // 全局帧调度器：限制所有进度条合计的刷新频率，每帧合并各进度条的最新状态并丢弃中间状态。
+    // 同时维护进度条所在的行：同时存在的进度条组成一个"块"，每个进度条占块内一行，
+    // 块内所有进度条完成后光标移到块下方，下一个进度条从新行开始。
+    class FrameScheduler {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        static FrameScheduler &instance();
+
+        // 当前时间，来自 PulseBar::setClock() 注入的时钟，默认为 steady_clock
+        static Clock::time_point now() {
+            const ClockSource *clock = clock_.load(std::memory_order_relaxed);
+            return clock ? clock->now() : Clock::now();
+        }
+
+        // 为所有进度条采样、执行看门狗检查并输出被推迟的帧。通常由节拍线程调用，
+        // 使用手动时钟时测试可直接调用以获得确定的结果
+        void tick();
+
+        // 预留行与帧缓冲区，避免稳定运行后因长度波动再次扩容
+        FrameScheduler() {
+            line_.reserve(1024);
+            frame_.reserve(4096);
+        }
+
+        ~FrameScheduler() {
+            stopTicker();
+        }
+
+        // 每秒最多输出的合成帧数；<= 0 表示不限制
+        void setMaxFps(double fps);
+        double maxFps() const;
+
+        // 立即输出所有待绘制的进度条
+        void flush();
+
+        // 帧预算允许输出下一帧的最早时刻
+        Clock::time_point nextFrameTime() const;
+
+        // 因与该行上一次写出的内容完全相同而被省略的行写入次数
+        std::uint64_t dedupedWrites() const { return deduped_writes_.load(std::memory_order_relaxed); }
+
+        // 已写出的合成帧数与字节数
+        std::uint64_t framesWritten() const { return frames_written_.load(std::memory_order_relaxed); }
+        std::uint64_t bytesWritten() const { return bytes_written_.load(std::memory_order_relaxed); }
+
+        // 后台节拍线程：定期为所有进度条采样、执行看门狗检查，并输出被帧预算推迟的帧，
+        // 即使工作线程没有调用 update() 也能保持刷新。配置看门狗时自动启动。
+        // 未启动周期节拍时，同一线程也负责在帧预算允许时补画被推迟的帧
+        void startTicker(double interval = 0.1);
+        void stopTicker();
+
+    private:
+        friend class PulseBar;
+        friend OverheadStats stats();
+
+        static inline std::atomic<const ClockSource *> clock_{nullptr};
+
+        int attach(PulseBar *bar);
+        void detach(PulseBar *bar);
+        void complete(PulseBar *bar);
+        void requestFrame(PulseBar *bar, bool force);
+        void newline();
+        void printLine(std::string_view text);
+        void endBlockIfIdle();
+        void retire(PulseBar *bar);
+        void moveCursorTo(int row);
+        std::size_t writeRow(int row);
+        void writeFrame();
+        void scheduleFlush(Clock::duration delay);
+        void flushDeferred();
+        void launchTicker();
+        void runTicker();
+
+        std::vector<PulseBar *> bars_;// 当前块中的进度条
+        int rows_ = 0;                // 当前块已占用的行数
+        int cursor_row_ = 0;          // 光标所在行（相对块首行）
+        int active_ = 0;              // 当前块中尚未完成的进度条数
+        std::size_t pending_ = 0;     // 等待绘制的进度条数
+        double frame_interval_ = 1.0 / 30;
+        Clock::time_point last_frame_time_{};
+        std::string frame_;
+        std::string line_;
+        std::vector<std::uint64_t> row_hashes_;// 每行最近一次写出内容的哈希，0 表示空行
+        std::atomic<std::uint64_t> deduped_writes_{0};
+        std::atomic<std::uint64_t> frames_written_{0};
+        std::atomic<std::uint64_t> bytes_written_{0};
+
+        // 开销统计，由 global_mtx_ 保护
+        std::uint64_t frames_built_ = 0;
+        std::uint64_t build_ns_ = 0;
+        std::uint64_t write_ns_ = 0;
+        std::uint64_t lock_wait_ns_ = 0;
+        std::uint64_t lock_contentions_ = 0;
+        std::uint64_t retired_update_calls_ = 0;// 已离开调度器的进度条的累计值
+        std::uint64_t retired_throttled_ = 0;
+        std::vector<BarObserver *> observers_;
+
+        // 节拍线程
+        std::thread ticker_;
+        std::mutex ticker_mtx_;
+        std::condition_variable ticker_cv_;
+        bool ticker_stop_ = false;
+        bool ticker_periodic_ = false;         // 由 startTicker() 开启的周期节拍
+        bool flush_scheduled_ = false;         // 有被推迟的帧等待补画
+        Clock::time_point flush_deadline_{};   // 补画时刻（真实时钟）
+        double tick_interval_ = 0.1;
+    };
+
+    // 看门狗判定的停滞类型
+    enum class StallKind {
+        NONE,
+        NO_PROGRESS,// 超过设定时间没有任何进度
+        SLOWDOWN,   // 短窗口速度低于长窗口速度的一定比例
+        SLOWER_THAN_HISTORY// 进度节奏明显慢于历史记录
+    };
+
+    using StallCallback = std::function<void(PulseBar &bar, StallKind kind)>;
+
+    // 某一时刻进度条状态的只读副本；label 仅在回调期间有效
+    struct BarSnapshot {
+        std::uint64_t id = 0;
+        std::uint64_t parent = 0;// 父进度条编号，0 表示没有
+        std::string_view label;
+        std::uint64_t count = 0;
+        std::uint64_t total = 0;
+        double rate = 0.0;   // 每秒项数
+        double eta = 0.0;    // 预计剩余秒数
+        double elapsed = 0.0;// 已用秒数
+        int width = 0;       // 进度条主体宽度
+        StallKind stall = StallKind::NONE;
+        bool completed = false;
+    };
+
+    // 进度条生命周期事件
+    enum class BarEvent {
+        CREATED,
+        LABEL_CHANGED,
+        COMPLETED,
+        DESTROYED
+    };
+
+    // 进度观察者：节拍线程每个节拍为每个存活的进度条调用一次 onSample，随后调用一次 onTickEnd；
+    // 生命周期事件在触发它的线程上通过 onEvent 通知。
+    // 回调时持有全局锁，实现应只做复制等轻量工作，把 I/O 留给自己的线程
+    class BarObserver {
+    public:
+        virtual ~BarObserver() = default;
+        virtual void onSample(const BarSnapshot &/*snapshot*/) {}
+        virtual void onTickEnd() {}
+        virtual void onEvent(BarEvent /*event*/, const BarSnapshot &/*snapshot*/) {}
+
+    protected:
+        // 回调所持有的全局锁；在回调之外读取回调中积累的状态时加锁
+        static std::unique_lock<std::recursive_mutex> lockCallbacks();
+    };
+
+    // 逐次更新的监听者：在调用 update()/advance() 的线程上不持锁地调用，实现必须线程安全且足够快。
+    // onUpdate 收到截断后的新计数，onAdvance 收到增量
+    class UpdateListener {
+    public:
+        virtual ~UpdateListener() = default;
+        virtual void onUpdate(std::uint64_t bar, std::uint64_t count) = 0;
+        virtual void onAdvance(std::uint64_t bar, std::uint64_t n) = 0;
+    };
+
     // 脉冲进度条类
     class PulseBar {
     public:
@@ -110,25 +1149,23 @@ namespace pulse {
             : PulseBar(100, 50, label, ColorType::BRIGHT_CYAN, ColorType::BRIGHT_WHITE, new DefaultPulseAnimation()) {
         }
 
-        explicit PulseBar(int total, const std::string &label)
+        explicit PulseBar(std::uint64_t total, const std::string &label)
             : PulseBar(total, 50, label, ColorType::BRIGHT_CYAN, ColorType::BRIGHT_WHITE, new DefaultPulseAnimation()) {
         }
 
-        explicit PulseBar(int total = 100,
+        explicit PulseBar(std::uint64_t total = 100,
                           int width = 50,
                           const std::string &label = "",// 修改：移除默认标签
                           ColorType bar_color = ColorType::BRIGHT_CYAN,
                           ColorType label_color = ColorType::BRIGHT_WHITE,
                           AnimationStrategy *animation = new DefaultPulseAnimation())
-            : total_(total),
+            : total_(std::max<std::uint64_t>(total, 1)),
               width_(width),
               label_(label.empty() ? "Progress" : label),
-              start_time_(std::chrono::high_resolution_clock::now()),
+              start_time_(FrameScheduler::now()),
               animation_(animation),
               last_print_time_(0.0),
               last_print_now_(0),
-              avg_time_(0.0),
-              smoothing_(0.3f),
               mininterval_(0.05),
               miniters_(0),
               bracket_callback_([](int percent) {// 修改：在初始化列表中直接初始化回调
@@ -142,234 +1179,835 @@ namespace pulse {
             label_color_code_ = ColorUtils::getAnsiCode(label_color);
             reset_code_ = ColorUtils::getAnsiCode(ColorType::RESET);
             time_color_code_ = ColorUtils::getAnsiCode(ColorType::MAGENTA);
+            estimator_->addSample(0.0, 0.0);
             enableAnsiTerminal();
-            initializeLineIndex();
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            row_ = FrameScheduler::instance().attach(this);
+            PULSE_PROBE2(create, id_, total_);
+            notify(BarEvent::CREATED);
         }
 
         ~PulseBar() {
-            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
-            moveCursorToLine(line_index_);
-            std::cout << "\033[2K";
-            if (line_index_ == next_line_index_ - 1) {
-                std::cout << "\r";
+            {
+                std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+                notify(BarEvent::DESTROYED);
+                FrameScheduler::instance().detach(this);
             }
-            std::cout.flush();
+            // 节拍线程可能正在锁外执行本进度条的停滞回调
+            while (stall_callbacks_in_flight_.load(std::memory_order_acquire) > 0) std::this_thread::yield();
         }
 
         void setAnimation(AnimationStrategy *animation) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
             animation_ = animation;
+            requestRedraw();
+        }
+
+        // 使用预渲染主题绘制主体，宽度随主题而定；传入 nullptr 恢复逐格渲染
+        void setTheme(const ThemeStrategy *theme) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            theme_ = theme;
+            if (theme_) width_ = theme_->width();
+            requestRedraw();
+        }
+
+        // 选择速率估计策略；传入 nullptr 恢复默认的 EMA
+        void setRateEstimator(RateEstimator *estimator) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            estimator_ = estimator ? estimator : &default_estimator_;
+            estimator_->reset();
+            double elapsed = elapsedSeconds();
+            estimator_->addSample(elapsed, static_cast<double>(current()));
+            next_sample_time_ = elapsed + sample_interval_;
+        }
+
+        // 速率估计的采样周期（秒），与刷新频率无关
+        void setSampleInterval(double seconds) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            sample_interval_ = std::max(seconds, 0.0);
+        }
+
+        // 开启逐项延迟统计：速度旁显示 p50/p99，complete() 时输出完整分位数汇总
+        void enableLatencyTracking() {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            if (latency_owner_) return;
+            latency_owner_ = std::make_unique<LatencyHistogram>();
+            latency_.store(latency_owner_.get(), std::memory_order_release);
+        }
+
+        using LatencyToken = FrameScheduler::Clock::time_point;
+
+        // 一项工作开始，返回的令牌交给 end()
+        LatencyToken begin() const {
+            return FrameScheduler::now();
+        }
+
+        void end(LatencyToken token) {
+            recordLatency(FrameScheduler::now() - token);
+        }
+
+        void recordLatency(std::chrono::nanoseconds latency) {
+            LatencyHistogram *histogram = latency_.load(std::memory_order_acquire);
+            if (histogram) histogram->record(static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count(), 0)));
+        }
+
+        // 作用域令牌：析构时记录本作用域耗时
+        class ScopedLatency {
+        public:
+            explicit ScopedLatency(PulseBar &bar) : bar_(bar), token_(bar.begin()) {}
+            ~ScopedLatency() { bar_.end(token_); }
+            ScopedLatency(const ScopedLatency &) = delete;
+            ScopedLatency &operator=(const ScopedLatency &) = delete;
+
+        private:
+            PulseBar &bar_;
+            LatencyToken token_;
+        };
+
+        ScopedLatency measure() {
+            return ScopedLatency(*this);
+        }
+
+        // 两次绘制之间的最小间隔（秒），默认 0.05 秒
+        void setMinInterval(double seconds) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            mininterval_ = std::max(seconds, 0.0);
+        }
+
+        // 两次绘制之间的最小计数增量，默认 0
+        void setMinIters(std::uint64_t iters) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            miniters_ = iters;
+        }
+
+        // 设置计数单位及缩放方式，例如 setUnit("B", UnitScale::IEC) 显示 MiB/s；缩放时同时显示 已完成/总量
+        void setUnit(const std::string &unit, UnitScale scale = UnitScale::NONE) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            unit_ = unit;
+            unit_scale_ = scale;
+            requestRedraw();
+        }
+
+        void setRateDisplay(RateDisplay display) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            rate_display_ = display;
+            requestRedraw();
+        }
+
+        void operator++() {
+            advance(1);
+        }
+
+        // 在当前计数上增加 n，适合按块报告的字节流
+        void advance(std::uint64_t n = 1) {
+            std::uint64_t prev = now_.fetch_add(n, std::memory_order_relaxed);
+            PULSE_PROBE3(update, id_, prev + n, total_);
+            if (count_updates_.load(std::memory_order_relaxed)) update_calls_.add();
+            if (UpdateListener *listener = update_listener_.load(std::memory_order_acquire)) listener->onAdvance(id_, n);
+            if (canSkip(prev, prev + n)) return;
+            auto lock = lockMeasured();
+            if (onProgress(false)) ++update_frames_;
+        }
+
+        void update(std::uint64_t now, bool force_complete = false) {
+            now = force_complete ? total_ : std::min(now, total_);
+            std::uint64_t prev = now_.exchange(now, std::memory_order_relaxed);
+            PULSE_PROBE3(update, id_, now, total_);
+            if (count_updates_.load(std::memory_order_relaxed)) update_calls_.add();
+            if (UpdateListener *listener = update_listener_.load(std::memory_order_acquire)) listener->onUpdate(id_, now);
+            if (!force_complete && canSkip(prev, now)) return;
+            auto lock = lockMeasured();
+            if (onProgress(force_complete)) ++update_frames_;
+        }
+
+        std::uint64_t count() const { return current(); }
+        std::uint64_t total() const { return total_; }
+
+        // 超过 seconds 秒没有进度即判定为停滞；0 关闭
+        void setStallTimeout(double seconds) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            stall_timeout_ = std::max(seconds, 0.0);
+            if (stall_timeout_ > 0) FrameScheduler::instance().startTicker();
+        }
+
+        // 最近 short_window 秒的速度低于最近 long_window 秒速度的 fraction 倍时判定为变慢；fraction 为 0 关闭
+        void setSlowdownDetection(double fraction, double short_window = 5.0, double long_window = 60.0) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            slowdown_fraction_ = std::clamp(fraction, 0.0, 1.0);
+            short_window_ = std::max(short_window, 0.1);
+            long_window_ = std::max(long_window, 2 * short_window_);
+            watch_samples_.clear();
+            if (slowdown_fraction_ > 0) FrameScheduler::instance().startTicker();
+        }
+
+        // 进入停滞/变慢状态时调用；在节拍线程中释放全局锁后执行，耗时的处理不会阻塞 update()。
+        // 回调返回前进度条不会析构完成，回调中不能销毁该进度条
+        void setStallCallback(StallCallback callback) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            stall_callback_ = std::move(callback);
+        }
+
+        // 关联历史记录：key 为空时使用标签。匹配到记录时按历史进度曲线估计 ETA 并预置速率估计；
+        // complete() 时写入本次运行。slow_factor > 0 时，节奏慢于历史该倍数即告警
+        void setHistory(HistoryStore *store, const std::string &key = "", double slow_factor = 1.5) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            history_store_ = store;
+            history_key_ = key.empty() ? label_ : key;
+            history_duration_ = 0.0;
+            history_slow_factor_ = std::max(slow_factor, 0.0);
+            HistoryStore::Record rec{};
+            if (store && store->find(history_key_, total_, rec)) {
+                // 总量不同时按比例缩放耗时
+                history_duration_ = rec.duration * static_cast<double>(total_) / static_cast<double>(rec.total);
+                std::copy(std::begin(rec.curve), std::end(rec.curve), history_curve_);
+                if (history_curve_[0] > 0.0f) {
+                    estimator_->seed(static_cast<double>(total_) / HistoryStore::kCurvePoints /
+                                     (history_curve_[0] * history_duration_));
+                }
+                if (history_slow_factor_ > 0) FrameScheduler::instance().startTicker();
+            }
+            requestRedraw();
+        }
+
+        StallKind stallState() const {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            return stall_state_;
+        }
+
+        // 本进度条自身的开销统计
+        BarStats stats() const {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            BarStats result;
+            result.id = id_;
+            result.label = label_;
+            result.update_calls = update_calls_.load();
+            result.frames_built = frames_built_;
+            result.frames_written = frames_written_;
+            result.bytes_written = bytes_written_;
+            result.build_ns = build_ns_;
+            result.lock_wait_ns = lock_wait_ns_;
+            result.throttled_updates = result.update_calls - std::min(result.update_calls, update_frames_);
+            return result;
+        }
+
+        // complete() 时输出一行开销报告，同时开启本进度条的更新计数
+        void setOverheadReport(bool enabled) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            overhead_report_ = enabled;
+            if (enabled) count_updates_.store(true, std::memory_order_relaxed);
         }
 
-        void operator++(){
-            ++now_;
+        // 更新调用计数是热路径上唯一的额外开销，默认关闭；开启后对之后创建的进度条生效。
+        // 关闭时 update_calls 与 throttled_updates 为 0，其余统计始终可用
+        static void setUpdateCounting(bool enabled) {
+            count_updates_default_.store(enabled, std::memory_order_relaxed);
         }
 
-        void update(int now, bool force_complete = false) {
+        // 进程内唯一的进度条编号，从 1 开始
+        std::uint64_t id() const { return id_; }
+
+        // 标记为另一个进度条的子任务，仅用于快照与遥测
+        void setParent(const PulseBar &parent) {
             std::lock_guard<std::recursive_mutex> lock(global_mtx_);
-            now_ = std::min(now, total_);
-            if (force_complete) now_ = total_;
+            parent_id_ = parent.id_;
+        }
 
-            auto current_time = std::chrono::high_resolution_clock::now();
-            double elapsed = std::chrono::duration<double>(current_time - start_time_).count();
+        BarSnapshot snapshot() const {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            const std::uint64_t now = current();
+            double elapsed = elapsedSeconds();
+            BarSnapshot snap;
+            snap.id = id_;
+            snap.parent = parent_id_;
+            snap.label = label_;
+            snap.count = now;
+            snap.total = total_;
+            snap.rate = completed_ && elapsed > 0 ? static_cast<double>(now) / elapsed : estimator_->rate();
+            snap.eta = completed_ ? 0.0 : remainingSeconds(elapsed, now);
+            snap.elapsed = elapsed;
+            snap.width = width_;
+            snap.stall = stall_state_;
+            snap.completed = completed_;
+            return snap;
+        }
 
-            // 双阈值刷新控制
-            int delta_now = now_ - last_print_now_;
-            double delta_time = elapsed - last_print_time_;
-            if (delta_time >= mininterval_ && delta_now >= miniters_) {
-                buildAndPrintProgress(elapsed);
-                last_print_time_ = elapsed;
-                last_print_now_ = now_;
+        // 注册观察者并启动节拍线程；移除后不会再收到回调
+        static void addObserver(BarObserver *observer) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+                FrameScheduler::instance().observers_.push_back(observer);
             }
+            FrameScheduler::instance().startTicker();
+        }
+
+        // 设置逐次更新的监听者；传入 nullptr 移除。移除后须确认没有线程仍在更新进度条才能销毁旧的监听者
+        static void setUpdateListener(UpdateListener *listener) {
+            update_listener_.store(listener, std::memory_order_release);
+        }
+
+        static void removeObserver(BarObserver *observer) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            auto &observers = FrameScheduler::instance().observers_;
+            observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
         }
 
         void complete() {
-            update(total_, true);
             std::lock_guard<std::recursive_mutex> lock(global_mtx_);
-            moveCursorToLine(line_index_);
-            std::cout << std::endl;
+            if (completed_) return;
+            stall_state_ = StallKind::NONE;
+            update(total_, true);
+            completed_ = true;
+            recordHistory();
+            PULSE_PROBE3(complete, id_, total_,
+                         std::chrono::duration_cast<std::chrono::nanoseconds>(FrameScheduler::now() - start_time_).count());
+            notify(BarEvent::COMPLETED);
+            if (latency_owner_) {
+                FrameScheduler::instance().printLine(buildLatencySummary());
+            }
+            if (overhead_report_) {
+                FrameScheduler::instance().printLine(buildOverheadReport());
+            }
+            FrameScheduler::instance().complete(this);
         }
 
         void setLabel(const std::string &new_label) {
             std::lock_guard<std::recursive_mutex> lock(global_mtx_);
-            label_ = new_label;
-            update(now_, false);
+            if (new_label != label_) {
+                requestRedraw();
+                label_ = new_label;
+                notify(BarEvent::LABEL_CHANGED);
+            }
+            update(current(), false);
         }
 
         void setBracketCallback(BracketCallback callback) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
             bracket_callback_ = callback;
+            requestRedraw();
         }
 
         void setColorBlendCallback(ColorBlendCallback callback) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
             color_blend_callback_ = callback;
+            requestRedraw();
         }
 
         void setTimeColor(ColorType time_color) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
             time_color_code_ = ColorUtils::getAnsiCode(time_color);
+            requestRedraw();
         }
 
         void setTimeFormat(const std::string &format) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
             time_format_ = format;
+            requestRedraw();
         }
 
         static void newline() {
             std::lock_guard<std::recursive_mutex> lock(global_mtx_);
-            std::cout << "\n";
-            next_line_index_++;
+            FrameScheduler::instance().newline();
+        }
+
+        // 设置所有进度条共用的时钟；传入 nullptr 恢复 steady_clock。
+        // 新旧时钟的纪元不同：上一帧时刻与已有进度条的起始时刻按两者之差平移，经过时间保持连续
+        static void setClock(const ClockSource *clock) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            FrameScheduler &scheduler = FrameScheduler::instance();
+            auto before = FrameScheduler::now();
+            FrameScheduler::clock_.store(clock, std::memory_order_relaxed);
+            auto shift = FrameScheduler::now() - before;
+            scheduler.last_frame_time_ += shift;
+            for (PulseBar *bar: scheduler.bars_) {
+                bar->start_time_ += shift;
+                bar->requestRedraw();
+            }
+        }
+
+        // 设置所有进度条共用的输出目标；传入 nullptr 恢复默认的 stderr
+        static void setOutputSink(OutputSink *sink) {
+            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
+            outputSink().flush();
+            sink_ = sink;
+        }
+
+        static OutputSink &outputSink() {
+            return sink_ ? *sink_ : defaultSink();
+        }
+
+        static OutputSink &defaultSink() {
+            static FdSink stderr_sink(
+#ifdef OS_WINDOWS
+                    _fileno(stderr)
+#else
+                    STDERR_FILENO
+#endif
+            );
+            return stderr_sink;
         }
 
     private:
-        void buildAndPrintProgress(double elapsed) {
-            int percent = calculatePercent(now_);
-            int filled = calculateFilledWidth(now_);
-
-            // 计算剩余时间（EMA）
-            double remaining = 0.0;
-            if (now_ > 0) {
-                double delta_t = elapsed - last_print_time_;
-                double delta_it = now_ - last_print_now_;
-                if (delta_t > 0 && delta_it > 0) {
-                    double current_rate = delta_t / delta_it;
-                    if (avg_time_ == 0.0) {
-                        avg_time_ = current_rate;
-                    } else {
-                        avg_time_ = smoothing_ * current_rate + (1 - smoothing_) * avg_time_;
-                    }
+        friend class FrameScheduler;
+        friend class BarObserver;
+        friend OverheadStats stats();
+
+        // 通知所有观察者，调用方需持有 global_mtx_
+        void notify(BarEvent event) const {
+            const auto &observers = FrameScheduler::instance().observers_;
+            if (observers.empty()) return;
+            BarSnapshot snap = snapshot();
+            for (BarObserver *observer : observers) observer->onEvent(event, snap);
+        }
+
+        double elapsedSeconds() const {
+            return std::chrono::duration<double>(FrameScheduler::now() - start_time_).count();
+        }
+
+        // operator++/advance 可能越过总数，显示时截断
+        std::uint64_t current() const {
+            return std::min(now_.load(std::memory_order_relaxed), total_);
+        }
+
+        // 无锁快速路径：计数仍在可见阈值区间内且未到下一个检查时刻时无需加锁。
+        // 读时钟比计数检查贵得多，高速循环中只在计数跨过步长整数倍时读时钟；
+        // 计数没有变化（任务停滞）时总要读时钟，否则经过时间、ETA 与速度会停在最后一帧
+        bool canSkip(std::uint64_t prev, std::uint64_t now) const {
+            if (now < gate_low_.load(std::memory_order_relaxed) ||
+                now >= gate_high_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::uint64_t mask = gate_clock_mask_.load(std::memory_order_relaxed);
+            if (prev != now && (prev | mask) == (now | mask)) return true;
+            return detail::toNanos(FrameScheduler::now()) < gate_time_.load(std::memory_order_relaxed);
+        }
+
+        // 样式变化后关闭快速路径，下一次更新必须加锁重绘；调用方需持有 global_mtx_
+        void requestRedraw() {
+            redraw_pending_ = true;
+            gate_high_.store(0, std::memory_order_relaxed);
+        }
+
+        // 获取全局锁；需要等待时把等待时间计入开销统计
+        std::unique_lock<std::recursive_mutex> lockMeasured() {
+            std::unique_lock<std::recursive_mutex> lock(global_mtx_, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                auto start = FrameScheduler::Clock::now();
+                lock.lock();
+                auto waited = static_cast<std::uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(FrameScheduler::Clock::now() - start).count());
+                lock_wait_ns_ += waited;
+                FrameScheduler &scheduler = FrameScheduler::instance();
+                scheduler.lock_wait_ns_ += waited;
+                ++scheduler.lock_contentions_;
+            }
+            return lock;
+        }
+
+        // 加锁后的刷新判断，调用方需持有 global_mtx_；返回是否请求了绘制
+        bool onProgress(bool force) {
+            if (completed_) return false;
+            const std::uint64_t now = current();
+            double elapsed = elapsedSeconds();
+            sampleRate(elapsed, now, force);
+
+            // 双阈值刷新控制，输出与上一帧相同时跳过构建；强制完成时总是绘制最终状态
+            bool due = force;
+            if (!force) {
+                bool interval_ok = elapsed - last_print_time_ >= mininterval_;
+                bool iters_ok = now < last_print_now_ || now - last_print_now_ >= miniters_;
+                due = interval_ok && iters_ok && hasVisibleChange(elapsed, now);
+            }
+
+            // 交给全局调度器，在帧预算内与其它进度条合并输出
+            if (due) FrameScheduler::instance().requestFrame(this, force);
+            refreshGate(elapsed);
+            return due;
+        }
+
+        // 节拍线程调用：看门狗检查，并在没有 update() 时照常采样与刷新
+        void onTick() {
+            checkWatchdog(elapsedSeconds());
+            onProgress(false);
+        }
+
+        void checkWatchdog(double elapsed) {
+            if (stall_timeout_ <= 0 && slowdown_fraction_ <= 0 && history_slow_factor_ <= 0) return;
+            const std::uint64_t now = current();
+            if (now != last_seen_count_) {
+                last_seen_count_ = now;
+                last_progress_time_ = elapsed;
+            }
+
+            StallKind state = StallKind::NONE;
+            if (stall_timeout_ > 0 && elapsed - last_progress_time_ >= stall_timeout_) {
+                state = StallKind::NO_PROGRESS;
+            }
+            if (state == StallKind::NONE && slowdown_fraction_ > 0) {
+                watch_samples_.emplace_back(elapsed, now);
+                while (watch_samples_.size() > 2 && watch_samples_.front().first < elapsed - long_window_) {
+                    watch_samples_.pop_front();
                 }
-                double estimated_total = avg_time_ * total_;
-                remaining = estimated_total - elapsed;
-                if (remaining < 0) remaining = 0.0;
+                // 历史至少覆盖两个短窗口后才比较
+                double covered = elapsed - watch_samples_.front().first;
+                if (covered >= 2 * short_window_) {
+                    double long_rate = static_cast<double>(now - watch_samples_.front().second) / covered;
+                    auto it = watch_samples_.rbegin();
+                    while (std::next(it) != watch_samples_.rend() && it->first > elapsed - short_window_) ++it;
+                    double short_span = elapsed - it->first;
+                    double short_rate = short_span > 0 ? static_cast<double>(now - it->second) / short_span : long_rate;
+                    if (long_rate > 0 && short_rate < slowdown_fraction_ * long_rate) state = StallKind::SLOWDOWN;
+                }
+            }
+            // 完成 5% 以后才与历史比较
+            if (state == StallKind::NONE && history_duration_ > 0.0 && history_slow_factor_ > 0 &&
+                now * 20 >= total_ && historyPace(elapsed, now) > history_slow_factor_) {
+                state = StallKind::SLOWER_THAN_HISTORY;
+            }
+
+            if (state == stall_state_) return;
+            stall_state_ = state;
+            redraw_pending_ = true;
+            if (state != StallKind::NONE) stall_notice_ = state;
+        }
+
+        // 重新计算快速路径的放行区间：在此区间内的更新既不需要采样也不会改变输出
+        void refreshGate(double elapsed) {
+            std::uint64_t low = 0;
+            std::uint64_t high = std::numeric_limits<std::uint64_t>::max();
+            double until = next_sample_time_;
+            if (completed_) {
+                until = std::numeric_limits<double>::infinity();
+            } else if (dirty_) {
+                // 已在等待调度器出帧，计数变化无需再次请求
+                auto next_frame = FrameScheduler::instance().nextFrameTime();
+                until = std::min(until, std::chrono::duration<double>(next_frame - start_time_).count());
+            } else if (mininterval_ > 0 && elapsed < last_print_time_ + mininterval_) {
+                // elapsed 取自构建帧之前，mininterval 为 0 时不能据此放开计数区间
+                until = std::min(until, last_print_time_ + mininterval_);
+            } else if (redraw_pending_) {
+                high = 0;
+            } else {
+                low = visible_low_;
+                high = std::max(visible_high_, last_print_now_ + miniters_);
+                until = std::min(until, next_visible_time_);
+            }
+            std::int64_t until_ns = std::numeric_limits<std::int64_t>::max();
+            if (until < 1e9) {
+                until_ns = detail::toNanos(start_time_) + static_cast<std::int64_t>(until * 1e9);
             }
+            // 按当前速度选择读时钟的计数步长，使两次读时钟间隔约 1ms
+            double per_ms = estimator_->rate() / 1000.0;
+            std::uint64_t stride = per_ms >= 2.0 ? std::bit_floor(static_cast<std::uint64_t>(std::min(per_ms, 4096.0))) : 1;
+            gate_low_.store(low, std::memory_order_relaxed);
+            gate_high_.store(high, std::memory_order_relaxed);
+            gate_time_.store(until_ns, std::memory_order_relaxed);
+            gate_clock_mask_.store(stride - 1, std::memory_order_relaxed);
+        }
+
+        // 把当前状态渲染为一行追加到 out（不含光标移动），由调度器在合成帧时调用
+        void appendFrame(std::string &out) {
+            const std::uint64_t now = current();
+            const bool is_completed = now == total_;
+            double elapsed = elapsedSeconds();
+            int percent = calculatePercent(now);
+            int filled = calculateFilledWidth(now);
 
-            // 计算迭代速度
-            double iteration_speed = 0.0;
-            if (elapsed > 0) {
-                iteration_speed = now_ / elapsed;
+            // 计算剩余时间与迭代速度；完成后显示全程平均速度
+            double rate = estimator_->rate();
+            double remaining = remainingSeconds(elapsed, now);
+            double iteration_speed = rate;
+            if ((is_completed || rate <= 0.0) && elapsed > 0) {
+                iteration_speed = static_cast<double>(now) / elapsed;
             }
 
             // 构建进度条
-            moveCursorToLine(line_index_);
-            std::cout << "\r\033[2K";// 清除行
-            std::string bar = buildLabelString();
-            bar += buildProgressBar(now_, filled, elapsed, percent);
-            bar += buildTimeInfoImpl(elapsed, (now_ == total_), remaining, iteration_speed);
-            std::cout << bar << std::flush;
+            appendLabel(out);
+            appendProgressBar(out, filled, elapsed, percent);
+            appendTimeInfo(out, elapsed, is_completed, remaining, iteration_speed, now);
+
+            scheduleNextVisibleChange(elapsed, remaining, percent, filled, now);
+            last_print_time_ = elapsed;
+            last_print_now_ = now;
         }
 
-        int calculatePercent(int now) const {
-            return static_cast<int>((now * 100.0) / total_);
+        // 预计剩余秒数；速度未知时为 0
+        double remainingSeconds(double elapsed, std::uint64_t now) const {
+            if (history_duration_ > 0.0) {
+                // 按历史进度曲线估计，并以本次相对历史的快慢节奏修正
+                double expected = history_duration_ * historyCurveAt(now);
+                return std::max(0.0, historyPace(elapsed, now) * (history_duration_ - expected));
+            }
+            double rate = estimator_->rate();
+            return rate > 0.0 ? static_cast<double>(total_ - now) / rate : 0.0;
         }
 
-        int calculateFilledWidth(int now) const {
-            return static_cast<int>((now * width_) / total_);
+        // 按固定周期向速率估计器喂样本
+        void sampleRate(double elapsed, std::uint64_t now, bool force) {
+            if (!force && elapsed < next_sample_time_) return;
+            estimator_->addSample(elapsed, static_cast<double>(now));
+            next_sample_time_ = elapsed + sample_interval_;
+            // 记录进度每跨过 1/16 时的耗时，complete() 时写入历史
+            while (curve_marks_ < HistoryStore::kCurvePoints &&
+                   now >= detail::mulDivCeil(curve_marks_ + 1, total_, HistoryStore::kCurvePoints)) {
+                curve_times_[curve_marks_++] = elapsed;
+            }
         }
 
-        std::string buildLabelString() const {
-            return label_color_code_ + label_ + " " + reset_code_;
+        // 历史曲线上完成 now 时的耗时占比，分段线性插值
+        double historyCurveAt(std::uint64_t now) const {
+            double f = static_cast<double>(now) / static_cast<double>(total_) * HistoryStore::kCurvePoints;
+            auto i = static_cast<std::size_t>(f);
+            if (i >= HistoryStore::kCurvePoints) return 1.0;
+            double lower = i == 0 ? 0.0 : history_curve_[i - 1];
+            return lower + (history_curve_[i] - lower) * (f - i);
         }
 
-        std::string buildProgressBar(int now, int filled, double elapsed, int percent) const {
-            auto [left_bracket, right_bracket] = bracket_callback_(percent);
-            std::string bar;
-            bar += left_bracket;
+        // 本次运行相对历史的节奏（>1 表示更慢），进度越多越可信
+        double historyPace(double elapsed, std::uint64_t now) const {
+            double expected = history_duration_ * historyCurveAt(now);
+            if (expected <= 0.0) return 1.0;
+            double weight = std::min(1.0, static_cast<double>(now) / static_cast<double>(total_) * HistoryStore::kCurvePoints);
+            return 1.0 + weight * (elapsed / expected - 1.0);
+        }
 
-            for (int i = 0; i < width_; ++i) {
-                if (i < filled) {
-                    // 使用当前动画帧
-                    bar += ColorUtils::getAnsiCode(color_blend_callback_(i, width_, percent)) +
-                           (i == filled - 1 ? animation_->getCurrentFrame(elapsed, percent) : "█");
-                } else {
-                    bar += reset_code_ + " ";// 空格填充
-                }
+        void recordHistory() {
+            if (!history_store_) return;
+            double duration = elapsedSeconds();
+            if (duration <= 0.0) return;
+            float curve[HistoryStore::kCurvePoints];
+            for (std::size_t i = 0; i < HistoryStore::kCurvePoints; ++i) {
+                double t = i < curve_marks_ ? curve_times_[i] : duration;
+                curve[i] = static_cast<float>(std::min(t / duration, 1.0));
             }
-            bar += reset_code_ + right_bracket;
-            bar += " " + ColorUtils::getAnsiCode(ColorType::BRIGHT_GREEN) +
-                   std::to_string(percent) + "%" + reset_code_;
-            return bar;
+            history_store_->append(history_key_, total_, duration, curve);
         }
 
-        std::string buildTimeInfoImpl(double elapsed, bool is_completed, double remaining, double iteration_speed) const {
-            std::ostringstream oss;
-            std::string time_str;
+        // 判断自上一帧以来输出是否会变化：百分比/填充格数、ETA 秒数、动画帧
+        bool hasVisibleChange(double elapsed, std::uint64_t now) const {
+            if (redraw_pending_) return true;
+            if (now < visible_low_ || now >= visible_high_) return true;
+            return elapsed >= next_visible_time_;
+        }
 
-            if (!time_format_.empty()) {
-                std::string temp_format = time_format_;
-                double time_source = is_completed ? elapsed : remaining;
+        // 预先算出百分比与填充格数保持不变的计数区间，以及下一次 ETA/动画变化的时刻
+        void scheduleNextVisibleChange(double elapsed, double remaining, int percent, int filled, std::uint64_t now) {
+            redraw_pending_ = false;
+            visible_low_ = detail::mulDivCeil(percent, total_, 100);
+            if (now >= total_) {
+                visible_high_ = std::numeric_limits<std::uint64_t>::max();
+            } else {
+                visible_high_ = detail::mulDivCeil(percent + 1, total_, 100);
+            }
+            // 宽度为 0 时没有填充格，只有百分比决定可见变化
+            if (width_ > 0) {
+                visible_low_ = std::max(visible_low_, detail::mulDivCeil(filled, total_, width_));
+                if (now < total_) visible_high_ = std::min(visible_high_, detail::mulDivCeil(filled + 1, total_, width_));
+            }
+            // 显示带缩放单位的计数时，计数的每次变化都可见
+            if (unit_scale_ != UnitScale::NONE) {
+                visible_low_ = now;
+                visible_high_ = now + 1;
+            }
 
-                // 替换%S（整秒）
-                auto pos = temp_format.find("%S");
-                if (pos != std::string::npos) {
-                    int seconds = static_cast<int>(time_source);
-                    temp_format.replace(pos, 2, std::to_string(seconds));
+            // ETA 以整秒显示（带毫秒格式时每次都变化）
+            double next_time = std::numeric_limits<double>::infinity();
+            if (now < total_) {
+                double eta_step = 1.0;
+                if (time_format_.find("%3N") != std::string::npos) {
+                    eta_step = 0.0;
+                } else if (remaining > 0.0) {
+                    double fraction = remaining - std::floor(remaining);
+                    if (fraction > 0.0) eta_step = fraction;
                 }
+                next_time = elapsed + eta_step;
+            }
 
-                // 替换%3N（毫秒，补零至3位）
-                pos = temp_format.find("%3N");
-                if (pos != std::string::npos) {
-                    int milliseconds = static_cast<int>((time_source - static_cast<int>(time_source)) * 1000);
-                    std::ostringstream oss_ms;
-                    oss_ms << std::setw(3) << std::setfill('0') << milliseconds;
-                    temp_format.replace(pos, 3, oss_ms.str());
+            // 动画帧仅在有填充格时可见
+            if (filled > 0) {
+                double interval = animation_->frameInterval();
+                if (interval <= 0.0) {
+                    next_time = elapsed;
+                } else if (std::isfinite(interval)) {
+                    next_time = std::min(next_time, (std::floor(elapsed / interval) + 1) * interval);
                 }
+            }
+            next_visible_time_ = next_time;
+        }
 
-                // 拼接标签和单位
-                if (is_completed) {
-                    time_str = "Elapsed: " + temp_format + "s";
-                } else {
-                    time_str = "ETA: " + temp_format + "s";
-                }
+        int calculatePercent(std::uint64_t now) const {
+            return static_cast<int>(detail::mulDiv(now, 100, total_));
+        }
+
+        int calculateFilledWidth(std::uint64_t now) const {
+            if (width_ <= 0) return 0;
+            return static_cast<int>(detail::mulDiv(now, width_, total_));
+        }
+
+        // 以下 append* 直接追加到调度器复用的行缓冲区，稳定运行时不分配内存
+        void appendLabel(std::string &out) const {
+            out += label_color_code_;
+            out += label_;
+            out += ' ';
+            out += reset_code_;
+        }
+
+        void appendProgressBar(std::string &bar, int filled, double elapsed, int percent) const {
+            auto [left_bracket, right_bracket] = bracket_callback_(percent);
+            bar += left_bracket;
+
+            const char *glyph = filled > 0 ? animation_->getCurrentFrame(elapsed, percent) : "";
+            if (theme_) {
+                theme_->renderBody(bar, filled, glyph);
             } else {
-                if (is_completed) {
-                    time_str = "Elapsed: " + std::to_string(static_cast<int>(elapsed)) + "s";
-                } else {
-                    time_str = "ETA: " + std::to_string(static_cast<int>(remaining)) + "s";
+                for (int i = 0; i < width_; ++i) {
+                    if (i < filled) {
+                        // 使用当前动画帧
+                        bar += ColorUtils::getAnsiCodeView(color_blend_callback_(i, width_, percent));
+                        bar += (i == filled - 1 ? glyph : "█");
+                    } else {
+                        bar += reset_code_;
+                        bar += ' ';// 空格填充
+                    }
                 }
+                bar += reset_code_;
+            }
+            bar += right_bracket;
+            bar += ' ';
+            bar += ColorUtils::getAnsiCodeView(ColorType::BRIGHT_GREEN);
+            detail::appendInt(bar, percent);
+            bar += '%';
+            bar += reset_code_;
+        }
+
+        void appendTimeInfo(std::string &out, double elapsed, bool is_completed, double remaining, double iteration_speed,
+                            std::uint64_t now) const {
+            out += time_color_code_;
+            out += ' ';
+
+            // 缩放单位下显示 已完成/总量
+            if (unit_scale_ != UnitScale::NONE) {
+                detail::appendScaled(out, static_cast<double>(now), unit_scale_, unit_);
+                out += '/';
+                detail::appendScaled(out, static_cast<double>(total_), unit_scale_, unit_);
+                out += ' ';
             }
 
+            out += is_completed ? "Elapsed: " : "ETA: ";
+            double time_source = is_completed ? elapsed : remaining;
+            if (time_format_.empty()) {
+                detail::appendInt(out, static_cast<int>(time_source));
+            } else {
+                appendFormattedTime(out, time_source);
+            }
+            out += 's';
+
             // 添加迭代速度信息
-            std::ostringstream speed_oss;
-            speed_oss << std::fixed << std::setprecision(2) << iteration_speed;
-            std::string speed_str = speed_oss.str() + "it/s";
+            out += " [";
+            bool inverse = rate_display_ == RateDisplay::SECONDS_PER_UNIT ||
+                           (rate_display_ == RateDisplay::AUTO && iteration_speed > 0.0 && iteration_speed < 1.0);
+            if (inverse) {
+                char buf[48];
+                int len = std::snprintf(buf, sizeof(buf), "%.2fs/", iteration_speed > 0.0 ? 1.0 / iteration_speed : 0.0);
+                out.append(buf, static_cast<std::size_t>(std::clamp(len, 0, static_cast<int>(sizeof(buf)) - 1)));
+                out += unit_;
+            } else {
+                detail::appendScaled(out, iteration_speed, unit_scale_, unit_);
+                out += "/s";
+            }
+            if (latency_owner_) {
+                LatencyHistogram::Snapshot snap = latency_owner_->snapshot();
+                if (snap.count > 0) {
+                    out += " p50=";
+                    detail::appendDuration(out, snap.percentile(50));
+                    out += " p99=";
+                    detail::appendDuration(out, snap.percentile(99));
+                }
+            }
+            out += ']';
+            out += reset_code_;
 
-            return time_color_code_ + " " + time_str + " [" + speed_str + "]" + reset_code_;
+            if (stall_state_ != StallKind::NONE) {
+                out += ColorUtils::getAnsiCodeView(ColorType::BRIGHT_RED);
+                out += stall_state_ == StallKind::NO_PROGRESS ? " ⚠ STALLED"
+                       : stall_state_ == StallKind::SLOWDOWN  ? " ⚠ SLOW"
+                                                              : " ⚠ SLOWER THAN HISTORY";
+                out += reset_code_;
+            }
         }
 
-        void moveCursorToLine(int target_line) {
-            if (target_line > line_index_) {
-                std::cout << "\033[" << (target_line - line_index_) << "B";
-            } else if (target_line < line_index_) {
-                std::cout << "\033[" << (line_index_ - target_line) << "A";
+        // 按 time_format_ 输出时间：%S 替换为整秒，%3N 替换为补零的 3 位毫秒
+        void appendFormattedTime(std::string &out, double time_source) const {
+            int seconds = static_cast<int>(time_source);
+            int milliseconds = static_cast<int>((time_source - seconds) * 1000);
+            std::string_view format = time_format_;
+            for (std::size_t i = 0; i < format.size(); ++i) {
+                if (format.compare(i, 2, "%S") == 0) {
+                    detail::appendInt(out, seconds);
+                    ++i;
+                } else if (format.compare(i, 3, "%3N") == 0) {
+                    char buf[4] = {static_cast<char>('0' + milliseconds / 100 % 10),
+                                   static_cast<char>('0' + milliseconds / 10 % 10),
+                                   static_cast<char>('0' + milliseconds % 10), '\0'};
+                    out.append(buf, 3);
+                    i += 2;
+                } else {
+                    out += format[i];
+                }
             }
-            line_index_ = target_line;
-            std::cout << "\r";
         }
 
-        void enableAnsiTerminal() {
-#ifdef OS_WINDOWS
-            HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-            DWORD mode = 0;
-            GetConsoleMode(hOut, &mode);
-            mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-            SetConsoleMode(hOut, mode);
-#endif
+        std::string buildLatencySummary() const {
+            LatencyHistogram::Snapshot snap = latency_owner_->snapshot();
+            std::string summary = time_color_code_ + "  latency n=" + std::to_string(snap.count);
+            if (snap.count > 0) {
+                static const std::pair<const char *, double> points[] = {
+                        {"min", 0.0}, {"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p99.9", 99.9}, {"max", 100.0}};
+                for (const auto &[name, p]: points) {
+                    summary += std::string(" ") + name + "=" + detail::formatDuration(snap.percentile(p));
+                }
+            }
+            return summary + reset_code_;
         }
 
-        void initializeLineIndex() {
-            std::lock_guard<std::recursive_mutex> lock(global_mtx_);
-            static int global_next_line_index = 0;
-            line_index_ = global_next_line_index++;
-            if (line_index_ > 0) {
-                std::cout << "\n";
+        std::string buildOverheadReport() const {
+            BarStats s = stats();
+            double throttled = s.update_calls > 0 ? 100.0 * static_cast<double>(s.throttled_updates) / static_cast<double>(s.update_calls) : 0.0;
+            char buf[192];
+            std::snprintf(buf, sizeof(buf), "  overhead updates=%llu frames=%llu written=%llu bytes=%llu build=%s lock_wait=%s throttled=%.2f%%",
+                          static_cast<unsigned long long>(s.update_calls), static_cast<unsigned long long>(s.frames_built),
+                          static_cast<unsigned long long>(s.frames_written), static_cast<unsigned long long>(s.bytes_written),
+                          detail::formatDuration(static_cast<double>(s.build_ns)).c_str(),
+                          detail::formatDuration(static_cast<double>(s.lock_wait_ns)).c_str(), throttled);
+            return time_color_code_ + buf + reset_code_;
+        }
+
+        void enableAnsiTerminal() {
+#ifdef OS_WINDOWS
+            for (DWORD handle: {STD_OUTPUT_HANDLE, STD_ERROR_HANDLE}) {
+                HANDLE hOut = GetStdHandle(handle);
+                DWORD mode = 0;
+                GetConsoleMode(hOut, &mode);
+                mode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+                SetConsoleMode(hOut, mode);
             }
+#endif
         }
 
         // 成员变量
-        int total_;
+        std::uint64_t id_ = next_id_.fetch_add(1, std::memory_order_relaxed);
+        std::uint64_t parent_id_ = 0;
+        std::uint64_t total_;
         int width_;
         std::string label_ = "Progress";// 添加默认值初始化
-        std::chrono::time_point<std::chrono::high_resolution_clock> start_time_;
-        int line_index_;
-        int now_ = 0;
+        FrameScheduler::Clock::time_point start_time_;
+        int row_ = 0;
+        std::atomic<std::uint64_t> now_{0};
         AnimationStrategy *animation_;
+        const ThemeStrategy *theme_ = nullptr;
+
+        // 调度状态
+        bool dirty_ = false;
+        bool completed_ = false;
 
         // 回调函数
         BracketCallback bracket_callback_;
@@ -382,22 +2020,418 @@ namespace pulse {
         std::string time_color_code_;
         std::string time_format_;
 
-        // EMA 相关
-        double avg_time_;
-        float smoothing_;
+        // 单位与速度显示
+        std::string unit_ = "it";
+        UnitScale unit_scale_ = UnitScale::NONE;
+        RateDisplay rate_display_ = RateDisplay::UNITS_PER_SECOND;
+
+        // 速率估计
+        EmaRateEstimator default_estimator_;
+        RateEstimator *estimator_ = &default_estimator_;
+        double sample_interval_ = 0.1;
+        double next_sample_time_ = 0.0;
+
+        // 逐项延迟统计（可选）：latency_owner_ 由 global_mtx_ 保护；
+        // recordLatency() 不加锁，通过 latency_ 读取已发布的直方图
+        std::unique_ptr<LatencyHistogram> latency_owner_;
+        std::atomic<LatencyHistogram *> latency_{nullptr};
+
+        // 开销统计；除 update_calls_ 外由 global_mtx_ 保护
+        detail::ShardedCounter update_calls_;
+        std::atomic<bool> count_updates_{count_updates_default_.load(std::memory_order_relaxed)};
+        std::uint64_t update_frames_ = 0;// 触发了绘制请求的更新次数
+        std::uint64_t frames_built_ = 0;
+        std::uint64_t frames_written_ = 0;
+        std::uint64_t bytes_written_ = 0;
+        std::uint64_t build_ns_ = 0;
+        std::uint64_t lock_wait_ns_ = 0;
+        bool overhead_report_ = false;
+
+        // 看门狗
+        StallCallback stall_callback_;
+        StallKind stall_state_ = StallKind::NONE;
+        StallKind stall_notice_ = StallKind::NONE;// 待节拍线程在锁外回调的状态
+        std::atomic<int> stall_callbacks_in_flight_{0};
+        double stall_timeout_ = 0.0;
+        double slowdown_fraction_ = 0.0;
+        double short_window_ = 5.0;
+        double long_window_ = 60.0;
+        double last_progress_time_ = 0.0;
+        std::uint64_t last_seen_count_ = 0;
+        std::deque<std::pair<double, std::uint64_t>> watch_samples_;
+
+        // 历史记录
+        HistoryStore *history_store_ = nullptr;
+        std::string history_key_;
+        double history_duration_ = 0.0;// 匹配到的历史耗时（按总量缩放），0 表示无历史
+        double history_slow_factor_ = 0.0;
+        float history_curve_[HistoryStore::kCurvePoints] = {};
+        double curve_times_[HistoryStore::kCurvePoints] = {};
+        std::size_t curve_marks_ = 0;
 
         // 刷新控制
         double mininterval_;
-        unsigned miniters_;
+        std::uint64_t miniters_;
         double last_print_time_;
-        int last_print_now_;
+        std::uint64_t last_print_now_;
+
+        // 可见变化阈值
+        bool redraw_pending_ = true;
+        std::uint64_t visible_low_ = 0;
+        std::uint64_t visible_high_ = 0;
+        double next_visible_time_ = 0.0;
+
+        // 无锁快速路径的放行区间，在持锁时更新
+        std::atomic<std::uint64_t> gate_low_{0};
+        std::atomic<std::uint64_t> gate_high_{0};
+        std::atomic<std::int64_t> gate_time_{0};
+        std::atomic<std::uint64_t> gate_clock_mask_{0};
 
         // 静态成员
         static std::recursive_mutex global_mtx_;
-        static std::atomic<int> next_line_index_;
+        static std::atomic<std::uint64_t> next_id_;
+        static std::atomic<bool> count_updates_default_;
+        static std::atomic<UpdateListener *> update_listener_;
+        static OutputSink *sink_;
     };
 
     // 静态成员初始化
     inline std::recursive_mutex PulseBar::global_mtx_;
-    inline std::atomic<int> PulseBar::next_line_index_(0);
-}// namespace pulse
\ No newline at end of file
+    inline std::atomic<std::uint64_t> PulseBar::next_id_{1};
+    inline std::atomic<bool> PulseBar::count_updates_default_{false};
+    inline std::atomic<UpdateListener *> PulseBar::update_listener_{nullptr};
+    inline OutputSink *PulseBar::sink_ = nullptr;
+
+    inline std::unique_lock<std::recursive_mutex> BarObserver::lockCallbacks() {
+        return std::unique_lock<std::recursive_mutex>(PulseBar::global_mtx_);
+    }
+
+    // FrameScheduler 实现，所有私有接口都在 PulseBar::global_mtx_ 保护下调用
+    inline FrameScheduler &FrameScheduler::instance() {
+        // 先构造默认输出，保证它晚于调度器（及其节拍线程）析构
+        PulseBar::defaultSink();
+        static FrameScheduler scheduler;
+        return scheduler;
+    }
+
+    inline void FrameScheduler::startTicker(double interval) {
+        std::lock_guard<std::mutex> lock(ticker_mtx_);
+        tick_interval_ = std::max(interval, 0.001);
+        ticker_periodic_ = true;
+        launchTicker();
+        ticker_cv_.notify_all();
+    }
+
+    // 不能在持有 PulseBar::global_mtx_ 时调用
+    inline void FrameScheduler::stopTicker() {
+        {
+            std::lock_guard<std::mutex> lock(ticker_mtx_);
+            if (!ticker_.joinable()) return;
+            ticker_stop_ = true;
+        }
+        ticker_cv_.notify_all();
+        ticker_.join();
+        std::lock_guard<std::mutex> lock(ticker_mtx_);
+        ticker_periodic_ = false;
+        flush_scheduled_ = false;
+    }
+
+    // 安排节拍线程在 delay 之后补画被推迟的帧；调用方持有 global_mtx_
+    inline void FrameScheduler::scheduleFlush(Clock::duration delay) {
+        std::lock_guard<std::mutex> lock(ticker_mtx_);
+        auto deadline = Clock::now() + delay;
+        if (!flush_scheduled_ || deadline < flush_deadline_) flush_deadline_ = deadline;
+        flush_scheduled_ = true;
+        launchTicker();
+        ticker_cv_.notify_all();
+    }
+
+    // 补画时刻到达：帧预算仍不允许时按剩余时间再次安排。
+    // 注入的时钟不随真实时间前进，此时不再轮询，由下一次更新或 tick() 输出
+    inline void FrameScheduler::flushDeferred() {
+        std::lock_guard<std::recursive_mutex> lock(PulseBar::global_mtx_);
+        if (pending_ == 0) return;
+        auto wait = nextFrameTime() - now();
+        if (wait <= Clock::duration::zero()) {
+            flush();
+        } else if (!clock_.load(std::memory_order_relaxed)) {
+            scheduleFlush(std::max<Clock::duration>(wait, std::chrono::milliseconds(1)));
+        }
+    }
+
+    // 调用方持有 ticker_mtx_
+    inline void FrameScheduler::launchTicker() {
+        if (ticker_.joinable()) return;
+        ticker_stop_ = false;
+        ticker_ = std::thread([this] { runTicker(); });
+    }
+
+    inline void FrameScheduler::runTicker() {
+        std::unique_lock<std::mutex> lk(ticker_mtx_);
+        auto next_tick = Clock::now() + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(tick_interval_));
+        while (!ticker_stop_) {
+            auto wake = ticker_periodic_ ? next_tick : Clock::time_point::max();
+            if (flush_scheduled_) wake = std::min(wake, flush_deadline_);
+            if (wake == Clock::time_point::max()) {
+                ticker_cv_.wait(lk);
+            } else {
+                ticker_cv_.wait_until(lk, wake);
+            }
+            if (ticker_stop_) break;
+            auto t = Clock::now();
+            bool do_tick = ticker_periodic_ && t >= next_tick;
+            bool do_flush = flush_scheduled_ && t >= flush_deadline_;
+            if (!do_tick && !do_flush) continue;
+            if (do_tick) next_tick = t + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(tick_interval_));
+            if (do_flush) flush_scheduled_ = false;
+            lk.unlock();
+            // tick() 也会输出到期的推迟帧
+            if (do_tick) {
+                tick();
+            } else {
+                flushDeferred();
+            }
+            lk.lock();
+        }
+    }
+
+    inline void FrameScheduler::tick() {
+        struct StallNotice {
+            PulseBar *bar;
+            StallCallback callback;
+            StallKind kind;
+        };
+        std::vector<StallNotice> notices;
+        {
+            std::lock_guard<std::recursive_mutex> lock(PulseBar::global_mtx_);
+            // 回调中可能创建或销毁进度条，按下标遍历
+            for (std::size_t i = 0; i < bars_.size(); ++i) {
+                if (!bars_[i]->completed_) bars_[i]->onTick();
+            }
+            if (!observers_.empty()) {
+                for (std::size_t i = 0; i < bars_.size(); ++i) {
+                    BarSnapshot snap = bars_[i]->snapshot();
+                    for (BarObserver *observer : observers_) observer->onSample(snap);
+                }
+                for (BarObserver *observer : observers_) observer->onTickEnd();
+            }
+            if (pending_ > 0 && now() >= nextFrameTime()) flush();
+            for (PulseBar *bar : bars_) {
+                if (bar->stall_notice_ == StallKind::NONE) continue;
+                if (bar->stall_callback_) {
+                    notices.push_back({bar, bar->stall_callback_, bar->stall_notice_});
+                    bar->stall_callbacks_in_flight_.fetch_add(1, std::memory_order_relaxed);
+                }
+                bar->stall_notice_ = StallKind::NONE;
+            }
+        }
+        // 停滞回调可能很慢（打印堆栈、降载），在锁外执行
+        for (StallNotice &notice : notices) {
+            notice.callback(*notice.bar, notice.kind);
+            notice.bar->stall_callbacks_in_flight_.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    inline void FrameScheduler::setMaxFps(double fps) {
+        std::lock_guard<std::recursive_mutex> lock(PulseBar::global_mtx_);
+        frame_interval_ = fps > 0 ? 1.0 / fps : 0.0;
+    }
+
+    inline double FrameScheduler::maxFps() const {
+        std::lock_guard<std::recursive_mutex> lock(PulseBar::global_mtx_);
+        return frame_interval_ > 0 ? 1.0 / frame_interval_ : 0.0;
+    }
+
+    inline FrameScheduler::Clock::time_point FrameScheduler::nextFrameTime() const {
+        return last_frame_time_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frame_interval_));
+    }
+
+    inline void FrameScheduler::flush() {
+        std::lock_guard<std::recursive_mutex> lock(PulseBar::global_mtx_);
+        if (pending_ == 0) return;
+        for (PulseBar *bar: bars_) {
+            if (!bar->dirty_) continue;
+            line_.clear();
+            auto build_start = Clock::now();
+            bar->appendFrame(line_);
+            auto build_ns = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - build_start).count());
+            PULSE_PROBE3(frame_build, bar->id_, line_.size(), build_ns);
+            ++bar->frames_built_;
+            bar->build_ns_ += build_ns;
+            ++frames_built_;
+            build_ns_ += build_ns;
+            bar->dirty_ = false;
+            if (std::size_t bytes = writeRow(bar->row_)) {
+                ++bar->frames_written_;
+                bar->bytes_written_ += bytes;
+            }
+        }
+        pending_ = 0;
+        last_frame_time_ = now();
+        writeFrame();
+    }
+
+    inline int FrameScheduler::attach(PulseBar *bar) {
+        flush();
+        if (rows_ > 0) {
+            // 从块的最后一行换行，为新进度条开辟一行
+            moveCursorTo(rows_ - 1);
+            frame_ += '\n';
+            cursor_row_ = rows_;
+            writeFrame();
+        }
+        bars_.push_back(bar);
+        ++active_;
+        return rows_++;
+    }
+
+    inline void FrameScheduler::detach(PulseBar *bar) {
+        auto it = std::find(bars_.begin(), bars_.end(), bar);
+        if (it == bars_.end()) return;
+        if (!bar->completed_) {
+            // 未完成就销毁的进度条保留其最终状态
+            requestFrame(bar, true);
+        }
+        retire(bar);
+        bars_.erase(it);
+        if (!bar->completed_) {
+            --active_;
+            endBlockIfIdle();
+        }
+    }
+
+    inline void FrameScheduler::complete(PulseBar *bar) {
+        if (std::find(bars_.begin(), bars_.end(), bar) == bars_.end()) return;
+        --active_;
+        endBlockIfIdle();
+    }
+
+    inline void FrameScheduler::requestFrame(PulseBar *bar, bool force) {
+        bool first_pending = false;
+        if (!bar->dirty_) {
+            bar->dirty_ = true;
+            first_pending = pending_++ == 0;
+        }
+        if (force || frame_interval_ <= 0 ||
+            std::chrono::duration<double>(now() - last_frame_time_).count() >= frame_interval_) {
+            flush();
+        } else if (first_pending) {
+            // 被帧预算推迟的帧不能依赖下一次 update()，进度条可能就此空闲
+            scheduleFlush(nextFrameTime() - now());
+        }
+    }
+
+    inline void FrameScheduler::newline() {
+        flush();
+        if (rows_ > 0) {
+            // 块仍在使用时换行只是在块内留出一个空行
+            moveCursorTo(rows_ - 1);
+            cursor_row_ = rows_++;
+        }
+        frame_ += '\n';
+        writeFrame();
+    }
+
+    // 在块的末尾新开一行输出一段文字（无块时直接输出在当前行）
+    inline void FrameScheduler::printLine(std::string_view text) {
+        flush();
+        if (rows_ > 0) {
+            moveCursorTo(rows_ - 1);
+            frame_ += '\n';
+            cursor_row_ = rows_++;
+        }
+        frame_ += "\r\033[2K";
+        frame_ += text;
+        if (rows_ == 0) frame_ += '\n';
+        writeFrame();
+    }
+
+    inline void FrameScheduler::endBlockIfIdle() {
+        if (active_ > 0 || rows_ == 0) return;
+        flush();
+        moveCursorTo(rows_ - 1);
+        frame_ += '\n';
+        writeFrame();
+        for (PulseBar *bar: bars_) retire(bar);
+        bars_.clear();
+        row_hashes_.clear();
+        rows_ = 0;
+        cursor_row_ = 0;
+    }
+
+    // 进度条离开调度器时把它的开销计数并入全局累计值
+    inline void FrameScheduler::retire(PulseBar *bar) {
+        BarStats s = bar->stats();
+        retired_update_calls_ += s.update_calls;
+        retired_throttled_ += s.throttled_updates;
+    }
+
+    inline void FrameScheduler::moveCursorTo(int row) {
+        if (row > cursor_row_) {
+            frame_ += "\033[";
+            detail::appendInt(frame_, row - cursor_row_);
+            frame_ += 'B';
+        } else if (row < cursor_row_) {
+            frame_ += "\033[";
+            detail::appendInt(frame_, cursor_row_ - row);
+            frame_ += 'A';
+        }
+        cursor_row_ = row;
+    }
+
+    // 写入一行；与该行上次写出的字节完全相同时跳过。返回追加到帧中的字节数
+    inline std::size_t FrameScheduler::writeRow(int row) {
+        if (row_hashes_.size() <= static_cast<std::size_t>(row)) row_hashes_.resize(row + 1, 0);
+        std::uint64_t hash = detail::fnv1a64(line_);
+        if (row_hashes_[row] == hash) {
+            deduped_writes_.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        row_hashes_[row] = hash;
+        std::size_t start = frame_.size();
+        moveCursorTo(row);
+        frame_ += "\r\033[2K";// 清除行
+        frame_ += line_;
+        return frame_.size() - start;
+    }
+
+    inline void FrameScheduler::writeFrame() {
+        if (frame_.empty()) return;
+        OutputSink &sink = PulseBar::outputSink();
+        auto write_start = Clock::now();
+        sink.write(frame_.data(), frame_.size());
+        sink.flush();
+        auto write_ns = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - write_start).count());
+        PULSE_PROBE2(write, frame_.size(), write_ns);
+        write_ns_ += write_ns;
+        frames_written_.fetch_add(1, std::memory_order_relaxed);
+        bytes_written_.fetch_add(frame_.size(), std::memory_order_relaxed);
+        frame_.clear();
+    }
+
+    // 所有进度条与渲染器的开销快照
+    inline OverheadStats stats() {
+        std::lock_guard<std::recursive_mutex> lock(PulseBar::global_mtx_);
+        FrameScheduler &scheduler = FrameScheduler::instance();
+        OverheadStats result;
+        result.update_calls = scheduler.retired_update_calls_;
+        result.throttled_updates = scheduler.retired_throttled_;
+        for (PulseBar *bar: scheduler.bars_) {
+            BarStats s = bar->stats();
+            result.update_calls += s.update_calls;
+            result.throttled_updates += s.throttled_updates;
+            result.bars.push_back(std::move(s));
+        }
+        result.frames_built = scheduler.frames_built_;
+        result.frames_written = scheduler.framesWritten();
+        result.bytes_written = scheduler.bytesWritten();
+        result.build_ns = scheduler.build_ns_;
+        result.write_ns = scheduler.write_ns_;
+        result.lock_wait_ns = scheduler.lock_wait_ns_;
+        result.lock_contentions = scheduler.lock_contentions_;
+        result.deduped_writes = scheduler.dedupedWrites();
+        return result;
+    }
+}// namespace pulse
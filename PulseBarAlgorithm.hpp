@@ -0,0 +1,191 @@
+#pragma once
+#include "PulseBarParallel.hpp"
+
+#include <execution>
+#include <iterator>
+#include <numeric>
+#include <optional>
+
+// 带进度的标准并行算法：pulse::for_each / transform / reduce / transform_reduce 与同名标准算法参数相同，
+// 末尾多一个进度条。输入按块划分（每个硬件线程约 16 块），块序号交给标准算法按给定的执行策略执行，
+// 每完成一块向按线程分片的计数器累加一次，由 detail::ChunkProgress 汇总后推进进度条。
+// 执行策略原样传给标准库；libstdc++ 在找到 TBB 时用它实现并行策略，此时需要链接 TBB
+namespace pulse {
+    namespace detail {
+        // 硬件线程数，只查询一次
+        inline std::size_t algorithmThreads() {
+            static const std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+            return threads;
+        }
+
+        // 每个硬件线程约 16 块：块数足够让各线程互相均衡，块内开销相对元素工作量又可以忽略
+        inline std::uint64_t algorithmGrain(std::uint64_t count) {
+            std::uint64_t chunks = algorithmThreads() * 16;
+            return std::max<std::uint64_t>((count + chunks - 1) / chunks, 1);
+        }
+
+        // 块序号的计数迭代器，让块列表不必实际分配；std::views::iota 的迭代器只被当作输入迭代器，不能交给并行策略
+        class ChunkIndex {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::uint64_t;
+            using difference_type = std::int64_t;
+            using pointer = const std::uint64_t *;
+            using reference = std::uint64_t;
+
+            ChunkIndex() = default;
+            explicit ChunkIndex(std::uint64_t value) : value_(value) {}
+
+            std::uint64_t operator*() const { return value_; }
+            std::uint64_t operator[](difference_type n) const { return value_ + static_cast<std::uint64_t>(n); }
+
+            ChunkIndex &operator++() { ++value_; return *this; }
+            ChunkIndex operator++(int) { ChunkIndex old = *this; ++value_; return old; }
+            ChunkIndex &operator--() { --value_; return *this; }
+            ChunkIndex operator--(int) { ChunkIndex old = *this; --value_; return old; }
+            ChunkIndex &operator+=(difference_type n) { value_ += static_cast<std::uint64_t>(n); return *this; }
+            ChunkIndex &operator-=(difference_type n) { value_ -= static_cast<std::uint64_t>(n); return *this; }
+
+            friend ChunkIndex operator+(ChunkIndex it, difference_type n) { return it += n; }
+            friend ChunkIndex operator+(difference_type n, ChunkIndex it) { return it += n; }
+            friend ChunkIndex operator-(ChunkIndex it, difference_type n) { return it -= n; }
+            friend difference_type operator-(ChunkIndex a, ChunkIndex b) { return static_cast<difference_type>(a.value_ - b.value_); }
+            friend auto operator<=>(ChunkIndex a, ChunkIndex b) = default;
+
+        private:
+            std::uint64_t value_ = 0;
+        };
+
+        // 块列表的执行策略：块内要更新计数器并可能推进进度条（会加锁），不能交给无序策略
+        template<class Policy>
+        auto chunkPolicy(Policy &&policy) {
+            using P = std::remove_cvref_t<Policy>;
+            if constexpr (std::is_same_v<P, std::execution::parallel_unsequenced_policy>) {
+                return std::execution::par;
+            } else if constexpr (std::is_same_v<P, std::execution::unsequenced_policy>) {
+                return std::execution::seq;
+            } else {
+                return std::forward<Policy>(policy);
+            }
+        }
+
+        // 块内可以向量化时（par_unseq / unseq）对块本身使用 unseq
+        template<class Policy>
+        inline constexpr bool kVectorizeChunk = std::is_same_v<std::remove_cvref_t<Policy>, std::execution::parallel_unsequenced_policy> ||
+                                                std::is_same_v<std::remove_cvref_t<Policy>, std::execution::unsequenced_policy>;
+
+        // 对 [0, count) 的每一块调用 body(lo, hi)，完成后推进进度条
+        template<class Policy, class Body>
+        void forEachChunk(Policy &&policy, std::uint64_t count, PulseBar &bar, Body body) {
+            if (count == 0) return;
+            std::uint64_t grain = algorithmGrain(count);
+            ChunkProgress progress(&bar, algorithmThreads());
+            const auto chunk_policy = chunkPolicy(std::forward<Policy>(policy));
+            std::for_each(chunk_policy, ChunkIndex(0), ChunkIndex((count + grain - 1) / grain), [&](std::uint64_t chunk) {
+                std::uint64_t lo = chunk * grain;
+                std::uint64_t hi = std::min(lo + grain, count);
+                body(lo, hi);
+                progress.add(hi - lo);
+            });
+            progress.publish();
+        }
+    }// namespace detail
+
+    template<class Policy, std::random_access_iterator It, class Fn>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    void for_each(Policy &&policy, It first, It last, Fn f, PulseBar &bar) {
+        detail::forEachChunk(std::forward<Policy>(policy), static_cast<std::uint64_t>(last - first), bar, [&](std::uint64_t lo, std::uint64_t hi) {
+            if constexpr (detail::kVectorizeChunk<Policy>) {
+                std::for_each(std::execution::unseq, first + lo, first + hi, f);
+            } else {
+                std::for_each(first + lo, first + hi, f);
+            }
+        });
+    }
+
+    template<class Policy, std::random_access_iterator It, std::random_access_iterator Out, class Op>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    Out transform(Policy &&policy, It first, It last, Out d_first, Op op, PulseBar &bar) {
+        auto count = last - first;
+        detail::forEachChunk(std::forward<Policy>(policy), static_cast<std::uint64_t>(count), bar, [&](std::uint64_t lo, std::uint64_t hi) {
+            if constexpr (detail::kVectorizeChunk<Policy>) {
+                std::transform(std::execution::unseq, first + lo, first + hi, d_first + lo, op);
+            } else {
+                std::transform(first + lo, first + hi, d_first + lo, op);
+            }
+        });
+        return d_first + count;
+    }
+
+    template<class Policy, std::random_access_iterator It1, std::random_access_iterator It2, std::random_access_iterator Out, class Op>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    Out transform(Policy &&policy, It1 first1, It1 last1, It2 first2, Out d_first, Op op, PulseBar &bar) {
+        auto count = last1 - first1;
+        detail::forEachChunk(std::forward<Policy>(policy), static_cast<std::uint64_t>(count), bar, [&](std::uint64_t lo, std::uint64_t hi) {
+            if constexpr (detail::kVectorizeChunk<Policy>) {
+                std::transform(std::execution::unseq, first1 + lo, first1 + hi, first2 + lo, d_first + lo, op);
+            } else {
+                std::transform(first1 + lo, first1 + hi, first2 + lo, d_first + lo, op);
+            }
+        });
+        return d_first + count;
+    }
+
+    // 每块先得到部分结果，结束后按块的顺序与 init 合并；与标准算法一样要求 reduce 满足结合律与交换律
+    template<class Policy, std::random_access_iterator It, class T, class Reduce, class Transform>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    T transform_reduce(Policy &&policy, It first, It last, T init, Reduce reduce, Transform transform, PulseBar &bar) {
+        auto count = static_cast<std::uint64_t>(last - first);
+        std::uint64_t grain = detail::algorithmGrain(count);
+        std::vector<std::optional<T>> partials((count + grain - 1) / grain);
+        detail::forEachChunk(std::forward<Policy>(policy), count, bar, [&](std::uint64_t lo, std::uint64_t hi) {
+            T first_value = transform(first[lo]);
+            if constexpr (detail::kVectorizeChunk<Policy>) {
+                partials[lo / grain].emplace(std::transform_reduce(std::execution::unseq, first + lo + 1, first + hi, std::move(first_value), reduce, transform));
+            } else {
+                partials[lo / grain].emplace(std::transform_reduce(first + lo + 1, first + hi, std::move(first_value), reduce, transform));
+            }
+        });
+        for (auto &partial: partials) init = reduce(std::move(init), std::move(*partial));
+        return init;
+    }
+
+    template<class Policy, std::random_access_iterator It1, std::random_access_iterator It2, class T, class Reduce, class Transform>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    T transform_reduce(Policy &&policy, It1 first1, It1 last1, It2 first2, T init, Reduce reduce, Transform transform, PulseBar &bar) {
+        auto count = static_cast<std::uint64_t>(last1 - first1);
+        std::uint64_t grain = detail::algorithmGrain(count);
+        std::vector<std::optional<T>> partials((count + grain - 1) / grain);
+        detail::forEachChunk(std::forward<Policy>(policy), count, bar, [&](std::uint64_t lo, std::uint64_t hi) {
+            T first_value = transform(first1[lo], first2[lo]);
+            if constexpr (detail::kVectorizeChunk<Policy>) {
+                partials[lo / grain].emplace(std::transform_reduce(std::execution::unseq, first1 + lo + 1, first1 + hi, first2 + lo + 1,
+                                                                   std::move(first_value), reduce, transform));
+            } else {
+                partials[lo / grain].emplace(std::transform_reduce(first1 + lo + 1, first1 + hi, first2 + lo + 1,
+                                                                   std::move(first_value), reduce, transform));
+            }
+        });
+        for (auto &partial: partials) init = reduce(std::move(init), std::move(*partial));
+        return init;
+    }
+
+    // 内积：reduce 为加法，transform 为乘法
+    template<class Policy, std::random_access_iterator It1, std::random_access_iterator It2, class T>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    T transform_reduce(Policy &&policy, It1 first1, It1 last1, It2 first2, T init, PulseBar &bar) {
+        return pulse::transform_reduce(std::forward<Policy>(policy), first1, last1, first2, std::move(init), std::plus<>(), std::multiplies<>(), bar);
+    }
+
+    template<class Policy, std::random_access_iterator It, class T, class Op = std::plus<>>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    T reduce(Policy &&policy, It first, It last, T init, Op op, PulseBar &bar) {
+        return pulse::transform_reduce(std::forward<Policy>(policy), first, last, std::move(init), op, std::identity(), bar);
+    }
+
+    template<class Policy, std::random_access_iterator It, class T>
+        requires std::is_execution_policy_v<std::remove_cvref_t<Policy>>
+    T reduce(Policy &&policy, It first, It last, T init, PulseBar &bar) {
+        return pulse::reduce(std::forward<Policy>(policy), first, last, std::move(init), std::plus<>(), bar);
+    }
+}// namespace pulse
@@ -0,0 +1,316 @@
+#pragma once
+#include "PulseBar.hpp"
+
+#ifndef OS_WINDOWS
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+namespace pulse {
+    // Prometheus 文本格式的指标导出：节拍线程把各进度条的快照复制进来，
+    // 文本文件与 HTTP 响应都在导出器自己的线程中生成，抓取时不会获取进度条的全局锁。
+    //   - serveTextfile：定期原子替换文件，供 node_exporter 的 textfile collector 读取
+    //   - serveHttp / serveUnixSocket：极简 HTTP 响应，仅监听回环地址或 Unix 套接字
+    class MetricsExporter : public BarObserver {
+    public:
+        MetricsExporter() {
+            PulseBar::addObserver(this);
+        }
+
+        // 不能在持有进度条全局锁时析构
+        ~MetricsExporter() override {
+            PulseBar::removeObserver(this);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            for (auto &worker : workers_) worker.join();
+#ifndef OS_WINDOWS
+            for (int fd : listen_fds_) ::close(fd);
+            for (const auto &path : unix_paths_) ::unlink(path.c_str());
+#endif
+        }
+
+        MetricsExporter(const MetricsExporter &) = delete;
+        MetricsExporter &operator=(const MetricsExporter &) = delete;
+
+        // 每 interval 秒先写 path.tmp 再重命名为 path，读取方永远看不到写了一半的文件
+        void serveTextfile(const std::string &path, double interval = 1.0) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            workers_.emplace_back([this, path, interval] {
+                std::unique_lock<std::mutex> lk(mtx_);
+                while (true) {
+                    bool stopping = cv_.wait_for(lk, std::chrono::duration<double>(interval), [this] { return stop_; });
+                    lk.unlock();
+                    writeTextfile(path);
+                    lk.lock();
+                    if (stopping) break;
+                }
+            });
+        }
+
+        // 在 127.0.0.1:port 上响应任意 GET 请求；失败返回 false
+        bool serveHttp(std::uint16_t port) {
+#ifdef OS_WINDOWS
+            return false;
+#else
+            int fd = openSocket(AF_INET);
+            if (fd < 0) return false;
+            int on = 1;
+            ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            return listenOn(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+#endif
+        }
+
+        bool serveUnixSocket(const std::string &path) {
+#ifdef OS_WINDOWS
+            return false;
+#else
+            sockaddr_un addr{};
+            if (path.size() >= sizeof(addr.sun_path)) return false;
+            int fd = openSocket(AF_UNIX);
+            if (fd < 0) return false;
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            ::unlink(path.c_str());
+            if (!listenOn(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr))) return false;
+            std::lock_guard<std::mutex> lock(mtx_);
+            unix_paths_.push_back(path);
+            return true;
+#endif
+        }
+
+        // 生成当前的指标文本
+        std::string render() const {
+            std::vector<Entry> entries;
+            OverheadStats overhead;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                entries = published_;
+                overhead = published_overhead_;
+            }
+            std::string out;
+            auto metric = [&](const char *name, const char *type, const char *help, auto value_of) {
+                out += "# HELP ";
+                out += name;
+                out += ' ';
+                out += help;
+                out += "\n# TYPE ";
+                out += name;
+                out += ' ';
+                out += type;
+                out += '\n';
+                for (const auto &entry : entries) {
+                    out += name;
+                    out += "{id=\"" + std::to_string(entry.snap.id) + "\",label=\"";
+                    appendEscaped(out, entry.label);
+                    out += "\"} ";
+                    appendNumber(out, value_of(entry.snap));
+                    out += '\n';
+                }
+            };
+            metric("pulsebar_count", "gauge", "Items completed.", [](const BarSnapshot &s) { return static_cast<double>(s.count); });
+            metric("pulsebar_total", "gauge", "Total items.", [](const BarSnapshot &s) { return static_cast<double>(s.total); });
+            metric("pulsebar_rate", "gauge", "Estimated items per second.", [](const BarSnapshot &s) { return s.rate; });
+            metric("pulsebar_eta_seconds", "gauge", "Estimated seconds remaining.", [](const BarSnapshot &s) { return s.eta; });
+            metric("pulsebar_elapsed_seconds", "gauge", "Seconds since the bar was created.", [](const BarSnapshot &s) { return s.elapsed; });
+            metric("pulsebar_stalled", "gauge", "Watchdog state: 0 ok, 1 no progress, 2 slowdown, 3 slower than history.",
+                   [](const BarSnapshot &s) { return static_cast<double>(s.stall); });
+            metric("pulsebar_completed", "gauge", "1 once the bar has completed.", [](const BarSnapshot &s) { return s.completed ? 1.0 : 0.0; });
+
+            // 渲染器自身开销，取自同一节拍的 pulse::stats()
+            auto counter = [&](const char *name, const char *help, double value) {
+                out += "# HELP ";
+                out += name;
+                out += ' ';
+                out += help;
+                out += "\n# TYPE ";
+                out += name;
+                out += " counter\n";
+                out += name;
+                out += ' ';
+                appendNumber(out, value);
+                out += '\n';
+            };
+            auto seconds = [](std::uint64_t ns) { return static_cast<double>(ns) / 1e9; };
+            counter("pulsebar_frames_built_total", "Bar rows rebuilt by the renderer.", static_cast<double>(overhead.frames_built));
+            counter("pulsebar_frames_written_total", "Composited frames written to the output sink.", static_cast<double>(overhead.frames_written));
+            counter("pulsebar_bytes_written_total", "Bytes written to the output sink.", static_cast<double>(overhead.bytes_written));
+            counter("pulsebar_deduped_writes_total", "Row writes skipped because the row was unchanged.", static_cast<double>(overhead.deduped_writes));
+            counter("pulsebar_build_seconds_total", "Time spent building bar rows.", seconds(overhead.build_ns));
+            counter("pulsebar_write_seconds_total", "Time spent writing frames to the output sink.", seconds(overhead.write_ns));
+            counter("pulsebar_lock_wait_seconds_total", "Time update() spent waiting for the global lock.", seconds(overhead.lock_wait_ns));
+            counter("pulsebar_lock_contentions_total", "update() calls that found the global lock held.", static_cast<double>(overhead.lock_contentions));
+            return out;
+        }
+
+        void onSample(const BarSnapshot &snapshot) override {
+            Entry &entry = staging_.emplace_back();
+            entry.snap = snapshot;
+            entry.label.assign(snapshot.label);
+            entry.snap.label = {};
+        }
+
+        // 节拍线程持有全局锁调用，此时读取开销计数是一致的
+        void onTickEnd() override {
+            OverheadStats overhead = pulse::stats();
+            overhead.bars.clear();
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                published_.swap(staging_);
+                published_overhead_ = std::move(overhead);
+            }
+            staging_.clear();
+        }
+
+    private:
+        struct Entry {
+            BarSnapshot snap;
+            std::string label;
+        };
+
+        static void appendEscaped(std::string &out, std::string_view text) {
+            for (char c : text) {
+                if (c == '\\' || c == '"') {
+                    out += '\\';
+                    out += c;
+                } else if (c == '\n') {
+                    out += "\\n";
+                } else {
+                    out += c;
+                }
+            }
+        }
+
+        static void appendNumber(std::string &out, double value) {
+            if (std::isinf(value)) {
+                out += value > 0 ? "+Inf" : "-Inf";
+                return;
+            }
+            char buf[32];
+            int len = std::snprintf(buf, sizeof(buf), "%.17g", value);
+            out.append(buf, static_cast<std::size_t>(len));
+        }
+
+        void writeTextfile(const std::string &path) const {
+            std::string text = render();
+            std::string tmp = path + ".tmp";
+            std::FILE *file = std::fopen(tmp.c_str(), "wb");
+            if (!file) return;
+            bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+            ok = std::fclose(file) == 0 && ok;
+            if (!ok) {
+                std::remove(tmp.c_str());
+                return;
+            }
+#ifdef OS_WINDOWS
+            MoveFileExA(tmp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+            std::rename(tmp.c_str(), path.c_str());
+#endif
+        }
+
+#ifndef OS_WINDOWS
+        // SOCK_CLOEXEC 与 accept4 只在 Linux 上可用，其它平台用 fcntl 设置 FD_CLOEXEC
+        static int openSocket(int domain) {
+#ifdef __linux__
+            return ::socket(domain, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+            int fd = ::socket(domain, SOCK_STREAM, 0);
+            if (fd >= 0) ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+            return fd;
+#endif
+        }
+
+        static int acceptClient(int fd) {
+#ifdef __linux__
+            return ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+            int client = ::accept(fd, nullptr, nullptr);
+            if (client >= 0) {
+                ::fcntl(client, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+                int on = 1;
+                ::setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+            }
+            return client;
+#endif
+        }
+
+        bool listenOn(int fd, const sockaddr *addr, socklen_t len) {
+            if (::bind(fd, addr, len) != 0 || ::listen(fd, 8) != 0) {
+                ::close(fd);
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(mtx_);
+            listen_fds_.push_back(fd);
+            workers_.emplace_back([this, fd] { acceptLoop(fd); });
+            return true;
+        }
+
+        void acceptLoop(int fd) {
+            while (true) {
+                {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    if (stop_) return;
+                }
+                // 定期醒来检查是否需要退出
+                pollfd pfd{fd, POLLIN, 0};
+                if (::poll(&pfd, 1, 100) <= 0) continue;
+                int client = acceptClient(fd);
+                if (client < 0) continue;
+                respond(client);
+                ::close(client);
+            }
+        }
+
+        // 读掉请求头后返回指标；请求内容不影响响应
+        void respond(int client) const {
+            char buf[1024];
+            pollfd pfd{client, POLLIN, 0};
+            std::string request;
+            while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192 && ::poll(&pfd, 1, 1000) > 0) {
+                ssize_t n = ::recv(client, buf, sizeof(buf), 0);
+                if (n <= 0) break;
+                request.append(buf, static_cast<std::size_t>(n));
+            }
+            std::string body = render();
+            std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            std::size_t written = 0;
+            while (written < response.size()) {
+                ssize_t n = ::send(client, response.data() + written, response.size() - written, kSendFlags);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return;
+                written += static_cast<std::size_t>(n);
+            }
+        }
+
+#ifdef MSG_NOSIGNAL
+        static constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+        static constexpr int kSendFlags = 0;// 由 SO_NOSIGPIPE 避免 SIGPIPE
+#endif
+
+        std::vector<int> listen_fds_;
+        std::vector<std::string> unix_paths_;
+#endif
+
+        std::vector<Entry> staging_;  // 仅节拍线程访问
+        std::vector<Entry> published_;// 最近一个节拍的完整快照
+        OverheadStats published_overhead_;
+        std::vector<std::thread> workers_;
+        mutable std::mutex mtx_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+    };
+}// namespace pulse
@@ -0,0 +1,341 @@
+#pragma once
+#include "PulseBar.hpp"
+
+#include <concepts>
+#include <exception>
+#include <type_traits>
+
+namespace pulse {
+    namespace detail {
+        // 按块汇总进度：完成一块只累加所属分片的计数（各占一条缓存行），
+        // 到了发布时刻由抢到发布权的线程求和后推进进度条，逐项与逐块都没有共享写
+        class ChunkProgress {
+        public:
+            ChunkProgress(PulseBar *bar, std::size_t shards)
+                : bar_(bar), shards_(std::max<std::size_t>(shards, 1)), cells_(std::make_unique<Cell[]>(shards_)) {
+                double fps = FrameScheduler::instance().maxFps();
+                interval_ns_ = fps > 0 ? static_cast<std::int64_t>(1e9 / fps) : 0;
+            }
+
+            // 每个分片对应一个子进度条（可为空），发布时一并更新
+            void setShardBars(std::vector<PulseBar *> bars) { shard_bars_ = std::move(bars); }
+
+            // 每个分片每 kClockStride 次累加才读一次时钟，块很小时也不会每块都读时钟
+            void add(std::size_t shard, std::uint64_t n) {
+                Cell &cell = cells_[shard % shards_];
+                cell.value.fetch_add(n, std::memory_order_relaxed);
+                if (cell.adds.fetch_add(1, std::memory_order_relaxed) % kClockStride != 0) return;
+                std::int64_t now = toNanos(FrameScheduler::now());
+                std::int64_t due = next_publish_ns_.load(std::memory_order_relaxed);
+                if (now < due) return;
+                if (!next_publish_ns_.compare_exchange_strong(due, now + interval_ns_, std::memory_order_relaxed)) return;
+                publish();
+            }
+
+            // 按线程选择分片
+            void add(std::uint64_t n) { add(threadShard(), n); }
+
+            // 把尚未发布的进度推进到进度条；已发布量只增不减，并发发布也不会重复推进
+            void publish() {
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < shards_; ++i) {
+                    std::uint64_t value = cells_[i].value.load(std::memory_order_relaxed);
+                    sum += value;
+                    if (i < shard_bars_.size() && shard_bars_[i]) shard_bars_[i]->update(value);
+                }
+                std::uint64_t prev = published_.load(std::memory_order_relaxed);
+                while (prev < sum && !published_.compare_exchange_weak(prev, sum, std::memory_order_relaxed)) {}
+                if (prev < sum && bar_) bar_->advance(sum - prev);
+            }
+
+            std::uint64_t load() const {
+                std::uint64_t sum = 0;
+                for (std::size_t i = 0; i < shards_; ++i) sum += cells_[i].value.load(std::memory_order_relaxed);
+                return sum;
+            }
+
+        private:
+            static constexpr std::uint32_t kClockStride = 4;
+
+            struct alignas(64) Cell {
+                std::atomic<std::uint64_t> value{0};
+                std::atomic<std::uint32_t> adds{0};
+            };
+
+            PulseBar *bar_;
+            std::size_t shards_;
+            std::unique_ptr<Cell[]> cells_;
+            std::vector<PulseBar *> shard_bars_;
+            std::int64_t interval_ns_ = 0;
+            alignas(64) std::atomic<std::int64_t> next_publish_ns_{0};
+            std::atomic<std::uint64_t> published_{0};
+        };
+    }// namespace detail
+
+    // 轻量的工作窃取线程池。每个工作线程持有一个由块区间组成的双端队列：
+    // 自己从队首逐块取，队列空了就从其他线程的队尾窃取半个区间。
+    // 调用 run() 的线程作为 0 号工作线程参与执行，因此 size() 个工作线程只需要 size()-1 个后台线程
+    class WorkStealingPool {
+    public:
+        // 块处理函数：(上下文, 块序号, 块最初所属的分区)
+        using ChunkFn = void (*)(void *, std::size_t, std::size_t);
+
+        // threads 为 0 时取硬件并发数
+        explicit WorkStealingPool(std::size_t threads = 0) {
+            if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+            for (std::size_t i = 0; i < threads; ++i) slots_.push_back(std::make_unique<Slot>());
+            for (std::size_t i = 1; i < threads; ++i) threads_.emplace_back([this, i] { workerLoop(i); });
+        }
+
+        ~WorkStealingPool() {
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            wake_cv_.notify_all();
+            for (auto &thread: threads_) thread.join();
+        }
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        // 进程内共享的默认线程池
+        static WorkStealingPool &shared() {
+            static WorkStealingPool pool;
+            return pool;
+        }
+
+        // 工作线程数（含调用线程）
+        std::size_t size() const { return slots_.size(); }
+
+        // 累计窃取次数
+        std::uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+        // 第 part 个分区的起始块：chunks 个块按序均分为 parts 个分区
+        static std::size_t partitionBegin(std::size_t chunks, std::size_t parts, std::size_t part) {
+            return static_cast<std::size_t>(detail::mulDiv(chunks, part, parts));
+        }
+
+        // 执行 [0, chunks) 的全部块后返回，第 i 个分区最初放进第 i 个工作线程的队列。
+        // 同一线程池同时只运行一个任务；在池内线程上再次调用（嵌套）时直接在当前线程串行执行
+        void run(std::size_t chunks, ChunkFn fn, void *ctx) {
+            if (chunks == 0) return;
+            if (current_ == this || size() == 1) {
+                for (std::size_t part = 0; part < size(); ++part) {
+                    std::size_t end = partitionBegin(chunks, size(), part + 1);
+                    for (std::size_t chunk = partitionBegin(chunks, size(), part); chunk < end; ++chunk) fn(ctx, chunk, part);
+                }
+                return;
+            }
+
+            std::lock_guard<std::mutex> run_lock(run_mtx_);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                fn_ = fn;
+                ctx_ = ctx;
+                remaining_.store(chunks, std::memory_order_relaxed);
+                for (std::size_t part = 0; part < size(); ++part) {
+                    Span span{partitionBegin(chunks, size(), part), partitionBegin(chunks, size(), part + 1), part};
+                    if (span.lo == span.hi) continue;
+                    std::lock_guard<std::mutex> slot_lock(slots_[part]->mtx);
+                    slots_[part]->spans.push_back(span);
+                }
+                ++generation_;
+            }
+            wake_cv_.notify_all();
+
+            current_ = this;
+            drain(0);
+            current_ = nullptr;
+
+            std::unique_lock<std::mutex> lock(mtx_);
+            done_cv_.wait(lock, [this] { return remaining_.load(std::memory_order_acquire) == 0; });
+        }
+
+    private:
+        // 连续的块区间 [lo, hi)，origin 为其最初所属的分区
+        struct Span {
+            std::size_t lo;
+            std::size_t hi;
+            std::size_t origin;
+        };
+
+        struct alignas(64) Slot {
+            std::mutex mtx;
+            std::deque<Span> spans;
+        };
+
+        void workerLoop(std::size_t index) {
+            current_ = this;
+            std::uint64_t seen = 0;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mtx_);
+                    wake_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                    if (stop_) return;
+                    seen = generation_;
+                }
+                drain(index);
+            }
+        }
+
+        // 先做自己队列里的块，再去窃取；所有队列都取不到时返回（在途的区间由窃取者完成）
+        void drain(std::size_t index) {
+            Span chunk{};
+            for (;;) {
+                if (!takeLocal(index, chunk)) {
+                    Span stolen{};
+                    if (!steal(index, stolen)) return;
+                    std::lock_guard<std::mutex> lock(slots_[index]->mtx);
+                    slots_[index]->spans.push_back(stolen);
+                    continue;
+                }
+                fn_(ctx_, chunk.lo, chunk.origin);
+                if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::lock_guard<std::mutex> lock(mtx_);
+                    done_cv_.notify_all();
+                }
+            }
+        }
+
+        // 从自己队首取一块
+        bool takeLocal(std::size_t index, Span &chunk) {
+            Slot &slot = *slots_[index];
+            std::lock_guard<std::mutex> lock(slot.mtx);
+            if (slot.spans.empty()) return false;
+            Span &front = slot.spans.front();
+            chunk = Span{front.lo, front.lo + 1, front.origin};
+            if (++front.lo == front.hi) slot.spans.pop_front();
+            return true;
+        }
+
+        // 从其他线程的队尾窃取：区间多于一块时取后一半，否则整块取走
+        bool steal(std::size_t thief, Span &stolen) {
+            for (std::size_t k = 1; k < size(); ++k) {
+                Slot &victim = *slots_[(thief + k) % size()];
+                std::lock_guard<std::mutex> lock(victim.mtx);
+                if (victim.spans.empty()) continue;
+                Span &back = victim.spans.back();
+                if (back.hi - back.lo > 1) {
+                    std::size_t mid = back.lo + (back.hi - back.lo) / 2;
+                    stolen = Span{mid, back.hi, back.origin};
+                    back.hi = mid;
+                } else {
+                    stolen = back;
+                    victim.spans.pop_back();
+                }
+                steals_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+
+        std::vector<std::unique_ptr<Slot>> slots_;
+        std::vector<std::thread> threads_;
+        std::mutex run_mtx_;// 串行化 run()
+        std::mutex mtx_;
+        std::condition_variable wake_cv_;
+        std::condition_variable done_cv_;
+        std::uint64_t generation_ = 0;
+        bool stop_ = false;
+        ChunkFn fn_ = nullptr;
+        void *ctx_ = nullptr;
+        std::atomic<std::size_t> remaining_{0};
+        std::atomic<std::uint64_t> steals_{0};
+        static inline thread_local WorkStealingPool *current_ = nullptr;// 当前线程正在为哪个线程池工作
+    };
+
+    // parallel_for 的可选设置
+    struct ParallelOptions {
+        WorkStealingPool *pool = nullptr;// 为空时使用 WorkStealingPool::shared()
+        bool worker_bars = false;        // 在总进度条下为每个分区显示一个子进度条
+    };
+
+    namespace detail {
+        template<std::integral Index, class Fn>
+        struct ParallelForJob {
+            Index begin;
+            std::uint64_t count;
+            std::uint64_t grain;
+            Fn &fn;
+            ChunkProgress &progress;
+            std::atomic<bool> failed{false};
+            std::exception_ptr error{};
+            std::mutex error_mtx{};
+
+            // fn 可以接收单个下标，也可以接收一块的 [lo, hi)；后者让块内循环由调用方自己写，便于向量化
+            static void runChunk(void *self, std::size_t chunk, std::size_t origin) {
+                auto &job = *static_cast<ParallelForJob *>(self);
+                std::uint64_t lo = chunk * job.grain;
+                std::uint64_t hi = std::min(lo + job.grain, job.count);
+                // 出错后剩下的块不再执行，也不计入进度
+                if (job.failed.load(std::memory_order_relaxed)) return;
+                try {
+                    Index first = static_cast<Index>(job.begin + static_cast<Index>(lo));
+                    Index last = static_cast<Index>(job.begin + static_cast<Index>(hi));
+                    if constexpr (std::is_invocable_v<Fn &, Index, Index>) {
+                        job.fn(first, last);
+                    } else {
+                        for (Index i = first; i != last; ++i) job.fn(i);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(job.error_mtx);
+                    if (!job.error) job.error = std::current_exception();
+                    job.failed.store(true, std::memory_order_relaxed);
+                    return;
+                }
+                job.progress.add(origin, hi - lo);
+            }
+        };
+
+        template<std::integral Index, class Fn>
+        void parallelFor(Index begin, Index end, std::uint64_t grain, Fn &fn, PulseBar &bar, const std::string &label,
+                         const ParallelOptions &options) {
+            WorkStealingPool &pool = options.pool ? *options.pool : WorkStealingPool::shared();
+            std::uint64_t count = end > begin ? static_cast<std::uint64_t>(end - begin) : 0;
+            if (grain == 0) grain = std::max<std::uint64_t>(count / (pool.size() * 16), 1);
+            std::size_t chunks = static_cast<std::size_t>((count + grain - 1) / grain);
+
+            ChunkProgress progress(&bar, pool.size());
+            std::vector<std::unique_ptr<PulseBar>> worker_bars;
+            if (options.worker_bars) {
+                std::vector<PulseBar *> shard_bars(pool.size(), nullptr);
+                for (std::size_t part = 0; part < pool.size(); ++part) {
+                    std::uint64_t lo = WorkStealingPool::partitionBegin(chunks, pool.size(), part) * grain;
+                    std::uint64_t hi = std::min<std::uint64_t>(WorkStealingPool::partitionBegin(chunks, pool.size(), part + 1) * grain, count);
+                    if (lo >= hi) continue;
+                    worker_bars.push_back(std::make_unique<PulseBar>(hi - lo, label + " #" + std::to_string(part)));
+                    worker_bars.back()->setParent(bar);
+                    shard_bars[part] = worker_bars.back().get();
+                }
+                progress.setShardBars(std::move(shard_bars));
+            }
+
+            ParallelForJob<Index, Fn> job{begin, count, grain, fn, progress};
+            pool.run(chunks, &ParallelForJob<Index, Fn>::runChunk, &job);
+            // 出错时进度条停在已完成的块上
+            progress.publish();
+            if (job.error) std::rethrow_exception(job.error);
+            for (auto &worker_bar: worker_bars) worker_bar->complete();
+        }
+    }// namespace detail
+
+    // 在工作窃取线程池上对 [begin, end) 并行执行 fn，并显示进度：
+    //   pulse::parallel_for(0, n, 1024, [&](int i) { work(i); }, "处理");
+    // fn 接收下标 i，或接收一块的 [lo, hi)。每块 grain 项（0 表示自动选择），
+    // 完成一块只写本分区的计数器，由汇总后的总进度条显示。fn 抛出的第一个异常在所有线程停止取块后重新抛出
+    template<std::integral Index, class Fn>
+    void parallel_for(Index begin, Index end, std::uint64_t grain, Fn &&fn, const std::string &label = "",
+                      const ParallelOptions &options = {}) {
+        PulseBar bar(end > begin ? static_cast<std::uint64_t>(end - begin) : 0, label);
+        detail::parallelFor(begin, end, grain, fn, bar, label, options);
+        bar.complete();
+    }
+
+    // 推进已有的进度条，不会将其完成
+    template<std::integral Index, class Fn>
+    void parallel_for(Index begin, Index end, std::uint64_t grain, Fn &&fn, PulseBar &bar,
+                      const ParallelOptions &options = {}) {
+        detail::parallelFor(begin, end, grain, fn, bar, std::string(bar.snapshot().label), options);
+    }
+}// namespace pulse
@@ -0,0 +1,264 @@
+#pragma once
+#include "PulseBar.hpp"
+
+#include <ranges>
+
+namespace pulse {
+    namespace detail {
+        // 默认批量：总量的约 1/steps，取 2 的幂并限制在 [1, 65536]，
+        // 共享状态最多被访问约 steps 次，慢循环仍然逐项刷新
+        inline std::uint64_t defaultTrackBatch(std::uint64_t total, std::uint64_t steps = 4096) {
+            return std::clamp<std::uint64_t>(std::bit_floor(total / steps), 1, 65536);
+        }
+    }// namespace detail
+
+    // 带进度的范围视图：迭代器在本地累计步数，每 batch 项才调用一次 bar.advance()，
+    // 与哨兵比较相等（循环结束）时补上零头。由 track() 创建的进度条归视图所有并在结束时完成；
+    // 中途 break 时进度条随视图销毁，停留在最后一次批量提交的位置。
+    // 同一视图的多个迭代器副本各自计数，只应沿一个迭代器遍历
+    template<std::ranges::view V>
+    class TrackView : public std::ranges::view_interface<TrackView<V>> {
+    public:
+        class Sentinel;
+
+        class Iterator {
+        public:
+            using iterator_concept = std::conditional_t<std::ranges::forward_range<V>, std::forward_iterator_tag, std::input_iterator_tag>;
+            using value_type = std::ranges::range_value_t<V>;
+            using difference_type = std::ranges::range_difference_t<V>;
+
+            Iterator() = default;
+            Iterator(std::ranges::iterator_t<V> current, const TrackView *parent)
+                : current_(std::move(current)), parent_(parent), left_(parent->batch_) {}
+
+            decltype(auto) operator*() const { return *current_; }
+
+            Iterator &operator++() {
+                ++current_;
+                if (--left_ == 0) left_ = commit(parent_);
+                return *this;
+            }
+
+            void operator++(int) requires(!std::ranges::forward_range<V>) { ++*this; }
+
+            Iterator operator++(int) requires std::ranges::forward_range<V> {
+                Iterator copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            friend bool operator==(const Iterator &a, const Iterator &b) requires std::ranges::forward_range<V> {
+                return a.current_ == b.current_;
+            }
+
+            // 到达末尾时提交零头；多次比较只提交一次
+            friend bool operator==(const Iterator &it, const Sentinel &s) {
+                if (it.current_ != s.base()) return false;
+                it.left_ = finish(it.parent_, it.left_);
+                return true;
+            }
+
+            const std::ranges::iterator_t<V> &base() const { return current_; }
+
+        private:
+            // 以下只接收值而不接收迭代器本身，循环中只有计数与位置需要留在寄存器里；返回新的剩余步数
+            static std::uint64_t commit(const TrackView *parent) {
+                parent->bar_->advance(parent->batch_);
+                return parent->batch_;
+            }
+
+            static std::uint64_t finish(const TrackView *parent, std::uint64_t left) {
+                std::uint64_t pending = parent->batch_ - left;
+                if (pending > 0) parent->bar_->advance(pending);
+                if (parent->owned_) parent->owned_->complete();
+                return parent->batch_;
+            }
+
+            std::ranges::iterator_t<V> current_{};
+            const TrackView *parent_ = nullptr;
+            mutable std::uint64_t left_ = 1;// 距下一次提交还剩的步数
+        };
+
+        class Sentinel {
+        public:
+            Sentinel() = default;
+            explicit Sentinel(std::ranges::sentinel_t<V> end) : end_(std::move(end)) {}
+
+            const std::ranges::sentinel_t<V> &base() const { return end_; }
+
+        private:
+            std::ranges::sentinel_t<V> end_{};
+        };
+
+        TrackView() = default;
+
+        // 推进已有的进度条；batch 为 0 时按进度条总量选择
+        TrackView(V base, PulseBar &bar, std::uint64_t batch = 0)
+            : base_(std::move(base)), bar_(&bar), batch_(batch ? batch : detail::defaultTrackBatch(bar.total())) {}
+
+        // 创建并持有进度条，总量取自范围大小
+        TrackView(V base, const std::string &label, std::uint64_t batch = 0)
+            requires std::ranges::forward_range<V> || std::ranges::sized_range<V>
+            : base_(std::move(base)) {
+            auto total = static_cast<std::uint64_t>(std::ranges::distance(base_));
+            owned_ = std::make_shared<PulseBar>(total, label);
+            bar_ = owned_.get();
+            batch_ = batch ? batch : detail::defaultTrackBatch(total);
+        }
+
+        Iterator begin() { return Iterator(std::ranges::begin(base_), this); }
+        Sentinel end() { return Sentinel(std::ranges::end(base_)); }
+
+        auto size() requires std::ranges::sized_range<V> { return std::ranges::size(base_); }
+
+        V base() const & requires std::copy_constructible<V> { return base_; }
+        PulseBar &bar() const { return *bar_; }
+
+    private:
+        V base_ = V();
+        std::shared_ptr<PulseBar> owned_;// 视图副本共享同一个进度条
+        PulseBar *bar_ = nullptr;
+        std::uint64_t batch_ = 1;
+    };
+
+    // 遍历 range 并显示进度：for (auto &x : pulse::track(items, "处理")) ...
+    template<std::ranges::viewable_range R>
+        requires std::ranges::forward_range<R> || std::ranges::sized_range<R>
+    auto track(R &&range, const std::string &label = "", std::uint64_t batch = 0) {
+        return TrackView<std::views::all_t<R>>(std::views::all(std::forward<R>(range)), label, batch);
+    }
+
+    // 遍历 range 时推进已有的进度条
+    template<std::ranges::viewable_range R>
+    auto track(R &&range, PulseBar &bar, std::uint64_t batch = 0) {
+        return TrackView<std::views::all_t<R>>(std::views::all(std::forward<R>(range)), bar, batch);
+    }
+
+    // 按块遍历并显示进度：每个元素是基础范围中最多 chunk 项的子范围，每完成一块推进一次。
+    // chunk 为 0 时取总量的约 1/1024。内层循环里没有任何进度相关的代码，可以照常向量化：
+    //   for (auto block : pulse::track_chunks(data)) for (int x : block) sum += x;
+    template<std::ranges::view V>
+        requires std::ranges::random_access_range<V> && std::ranges::sized_range<V>
+    class TrackChunksView : public std::ranges::view_interface<TrackChunksView<V>> {
+    public:
+        using difference_type = std::ranges::range_difference_t<V>;
+
+        class Iterator {
+        public:
+            using iterator_concept = std::input_iterator_tag;
+            using value_type = std::ranges::subrange<std::ranges::iterator_t<V>>;
+            using difference_type = TrackChunksView::difference_type;
+
+            Iterator() = default;
+            explicit Iterator(TrackChunksView *parent) : parent_(parent) {}
+
+            value_type operator*() const {
+                auto first = std::ranges::begin(parent_->base_) + offset_;
+                return value_type(first, first + blockSize());
+            }
+
+            Iterator &operator++() {
+                difference_type size = blockSize();
+                offset_ += size;
+                parent_->bar_->advance(static_cast<std::uint64_t>(size));
+                return *this;
+            }
+
+            void operator++(int) { ++*this; }
+
+            friend bool operator==(const Iterator &it, std::default_sentinel_t) {
+                return it.reachedEnd();
+            }
+
+        private:
+            bool reachedEnd() const {
+                if (offset_ < parent_->size()) return false;
+                if (parent_->owned_) parent_->owned_->complete();
+                return true;
+            }
+
+            difference_type blockSize() const {
+                return std::min(parent_->chunk_, parent_->size() - offset_);
+            }
+
+            TrackChunksView *parent_ = nullptr;
+            difference_type offset_ = 0;
+        };
+
+        TrackChunksView() = default;
+        TrackChunksView(V base, std::size_t chunk, const std::string &label)
+            : base_(std::move(base)), chunk_(chunkSize(chunk)),
+              owned_(std::make_shared<PulseBar>(static_cast<std::uint64_t>(std::ranges::size(base_)), label)),
+              bar_(owned_.get()) {}
+        TrackChunksView(V base, std::size_t chunk, PulseBar &bar)
+            : base_(std::move(base)), chunk_(chunkSize(chunk)), bar_(&bar) {}
+
+        Iterator begin() { return Iterator(this); }
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+
+        // 块数
+        std::size_t blocks() const {
+            return static_cast<std::size_t>((size() + chunk_ - 1) / chunk_);
+        }
+
+        PulseBar &bar() const { return *bar_; }
+
+    private:
+        difference_type size() const { return static_cast<difference_type>(std::ranges::size(base_)); }
+
+        difference_type chunkSize(std::size_t chunk) const {
+            if (chunk == 0) chunk = detail::defaultTrackBatch(static_cast<std::uint64_t>(std::ranges::size(base_)), 1024);
+            return static_cast<difference_type>(chunk);
+        }
+
+        V base_ = V();
+        difference_type chunk_ = 1;
+        std::shared_ptr<PulseBar> owned_;
+        PulseBar *bar_ = nullptr;
+    };
+
+    template<std::ranges::viewable_range R>
+        requires std::ranges::random_access_range<R> && std::ranges::sized_range<R>
+    auto track_chunks(R &&range, std::size_t chunk = 0, const std::string &label = "") {
+        return TrackChunksView<std::views::all_t<R>>(std::views::all(std::forward<R>(range)), chunk, label);
+    }
+
+    template<std::ranges::viewable_range R>
+        requires std::ranges::random_access_range<R> && std::ranges::sized_range<R>
+    auto track_chunks(R &&range, std::size_t chunk, PulseBar &bar) {
+        return TrackChunksView<std::views::all_t<R>>(std::views::all(std::forward<R>(range)), chunk, bar);
+    }
+
+    namespace views {
+        // range 适配器：items | pulse::views::track 或 items | pulse::views::track(bar)
+        struct TrackFn {
+            struct BarClosure {
+                PulseBar *bar;
+                std::uint64_t batch;
+
+                template<std::ranges::viewable_range R>
+                friend auto operator|(R &&range, const BarClosure &closure) {
+                    return pulse::track(std::forward<R>(range), *closure.bar, closure.batch);
+                }
+            };
+
+            template<std::ranges::viewable_range R>
+                requires std::ranges::forward_range<R> || std::ranges::sized_range<R>
+            auto operator()(R &&range) const {
+                return pulse::track(std::forward<R>(range));
+            }
+
+            BarClosure operator()(PulseBar &bar, std::uint64_t batch = 0) const {
+                return BarClosure{&bar, batch};
+            }
+
+            template<std::ranges::viewable_range R>
+                requires std::ranges::forward_range<R> || std::ranges::sized_range<R>
+            friend auto operator|(R &&range, const TrackFn &) {
+                return pulse::track(std::forward<R>(range));
+            }
+        };
+
+        inline constexpr TrackFn track{};
+    }// namespace views
+}// namespace pulse
@@ -0,0 +1,397 @@
+#pragma once
+#include "PulseBar.hpp"
+
+#include <fstream>
+#include <unordered_map>
+
+namespace pulse {
+    // 会话记录的类型
+    enum class RecordType : std::uint8_t {
+        CREATE = 1,
+        UPDATE,
+        ADVANCE,
+        LABEL,
+        COMPLETE,
+        DESTROY
+    };
+
+    // 一条会话记录；ts_ns 为相对记录开始的纳秒数。
+    // value 对 CREATE/UPDATE 为计数，对 ADVANCE 为增量；parent/total/width 只对 CREATE 有效
+    struct SessionRecord {
+        RecordType type = RecordType::UPDATE;
+        std::int64_t ts_ns = 0;
+        std::uint64_t bar = 0;
+        std::uint64_t value = 0;
+        std::uint64_t parent = 0;
+        std::uint64_t total = 0;
+        int width = 0;
+        std::string label;// LABEL/CREATE
+    };
+
+    namespace detail {
+        // 会话文件：8 字节魔数后是紧凑编码的记录流。每条记录为
+        // 类型字节、与上一条记录的时间差、进度条编号，以及按类型附带的字段；整数均为 LEB128 变长编码
+        inline constexpr char kSessionMagic[8] = {'P', 'B', 'S', 'E', 'S', 'S', '0', '1'};
+
+        inline void appendVarint(std::string &out, std::uint64_t value) {
+            while (value >= 0x80) {
+                out += static_cast<char>((value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            out += static_cast<char>(value);
+        }
+
+        inline bool readVarint(std::string_view &in, std::uint64_t &value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && !in.empty(); shift += 7) {
+                auto byte = static_cast<unsigned char>(in.front());
+                in.remove_prefix(1);
+                value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+
+        // last_ts 为同一流中上一条记录的时刻，编码后更新
+        inline void encodeRecord(std::string &out, const SessionRecord &r, std::int64_t &last_ts) {
+            out += static_cast<char>(r.type);
+            appendVarint(out, static_cast<std::uint64_t>(std::max<std::int64_t>(r.ts_ns - last_ts, 0)));
+            last_ts = std::max(r.ts_ns, last_ts);
+            appendVarint(out, r.bar);
+            switch (r.type) {
+                case RecordType::CREATE:
+                    appendVarint(out, r.parent);
+                    appendVarint(out, r.total);
+                    appendVarint(out, static_cast<std::uint64_t>(std::max(r.width, 0)));
+                    appendVarint(out, r.value);
+                    [[fallthrough]];
+                case RecordType::LABEL:
+                    appendVarint(out, r.label.size());
+                    out += r.label;
+                    break;
+                case RecordType::UPDATE:
+                case RecordType::ADVANCE:
+                    appendVarint(out, r.value);
+                    break;
+                case RecordType::COMPLETE:
+                case RecordType::DESTROY:
+                    break;
+            }
+        }
+
+        // 解码一条记录；输入不完整或类型未知时返回 false
+        inline bool decodeRecord(std::string_view &in, SessionRecord &r, std::int64_t &last_ts) {
+            if (in.empty()) return false;
+            auto type = static_cast<unsigned char>(in.front());
+            if (type < static_cast<unsigned char>(RecordType::CREATE) || type > static_cast<unsigned char>(RecordType::DESTROY)) return false;
+            in.remove_prefix(1);
+            r = SessionRecord();
+            r.type = static_cast<RecordType>(type);
+            std::uint64_t delta = 0;
+            if (!readVarint(in, delta) || !readVarint(in, r.bar)) return false;
+            last_ts += static_cast<std::int64_t>(delta);
+            r.ts_ns = last_ts;
+            std::uint64_t width = 0;
+            std::uint64_t length = 0;
+            switch (r.type) {
+                case RecordType::CREATE:
+                    if (!readVarint(in, r.parent) || !readVarint(in, r.total) || !readVarint(in, width) || !readVarint(in, r.value)) return false;
+                    r.width = static_cast<int>(width);
+                    [[fallthrough]];
+                case RecordType::LABEL:
+                    if (!readVarint(in, length) || length > in.size()) return false;
+                    r.label.assign(in.substr(0, length));
+                    in.remove_prefix(length);
+                    return true;
+                case RecordType::UPDATE:
+                case RecordType::ADVANCE:
+                    return readVarint(in, r.value);
+                case RecordType::COMPLETE:
+                case RecordType::DESTROY:
+                    return true;
+            }
+            return false;
+        }
+
+        // 按线程分块的追加日志：每个线程只向自己的缓冲区追加（写入无锁），
+        // 记录只写进整块中，读取方按 size/next 的发布顺序读到完整的记录
+        class ThreadLog {
+        public:
+            struct Chunk {
+                static constexpr std::size_t kCapacity = 64 * 1024;
+
+                explicit Chunk(std::size_t capacity) : data(new char[capacity]), capacity(capacity) {}
+
+                std::unique_ptr<char[]> data;
+                std::size_t capacity;
+                std::atomic<std::size_t> size{0};
+                std::atomic<Chunk *> next{nullptr};
+            };
+
+            struct Buffer {
+                Chunk head{Chunk::kCapacity};
+                Chunk *tail = &head;
+                std::int64_t last_ts = 0;
+                std::string scratch;// 编码缓冲，只由所属线程使用
+
+                Buffer() { scratch.reserve(64); }
+
+                ~Buffer() {
+                    Chunk *chunk = head.next.load(std::memory_order_relaxed);
+                    while (chunk) {
+                        Chunk *next = chunk->next.load(std::memory_order_relaxed);
+                        delete chunk;
+                        chunk = next;
+                    }
+                }
+            };
+
+            ThreadLog() = default;
+            ThreadLog(const ThreadLog &) = delete;
+            ThreadLog &operator=(const ThreadLog &) = delete;
+
+            // 调用线程在本日志中的缓冲区。线程局部缓存只记住最近使用的日志，
+            // 未命中时按线程编号查找，交替写入多个日志也不会重复登记
+            Buffer &local() {
+                thread_local std::uint64_t cached_generation = 0;
+                thread_local Buffer *cached_buffer = nullptr;
+                if (cached_generation == generation_) return *cached_buffer;
+                std::lock_guard<std::mutex> lock(mtx_);
+                std::unique_ptr<Buffer> &buffer = buffers_[std::this_thread::get_id()];
+                if (!buffer) buffer = std::make_unique<Buffer>();
+                cached_buffer = buffer.get();
+                cached_generation = generation_;
+                return *buffer;
+            }
+
+            // 当前块放不下时换一个新块，保证每条记录都完整地位于一个块中
+            static void commit(Buffer &buffer, std::string_view bytes) {
+                Chunk *chunk = buffer.tail;
+                std::size_t size = chunk->size.load(std::memory_order_relaxed);
+                if (chunk->capacity - size < bytes.size()) {
+                    Chunk *next = new Chunk(std::max(Chunk::kCapacity, bytes.size()));
+                    chunk->next.store(next, std::memory_order_release);
+                    buffer.tail = chunk = next;
+                    size = 0;
+                }
+                std::memcpy(chunk->data.get() + size, bytes.data(), bytes.size());
+                chunk->size.store(size + bytes.size(), std::memory_order_release);
+            }
+
+            // 对每个线程调用一次 fn(chunks)，chunks 为该线程已发布的数据块，按写入顺序排列
+            template <class Fn>
+            void forEachThread(Fn &&fn) const {
+                std::vector<std::string_view> chunks;
+                std::lock_guard<std::mutex> lock(mtx_);
+                for (const auto &entry : buffers_) {
+                    chunks.clear();
+                    for (const Chunk *chunk = &entry.second->head; chunk; chunk = chunk->next.load(std::memory_order_acquire)) {
+                        chunks.emplace_back(chunk->data.get(), chunk->size.load(std::memory_order_acquire));
+                    }
+                    fn(static_cast<const std::vector<std::string_view> &>(chunks));
+                }
+            }
+
+            // 登记过缓冲区的线程数
+            std::size_t threads() const {
+                std::lock_guard<std::mutex> lock(mtx_);
+                return buffers_.size();
+            }
+
+        private:
+            static inline std::atomic<std::uint64_t> next_generation_{1};
+
+            const std::uint64_t generation_ = next_generation_.fetch_add(1, std::memory_order_relaxed);
+            std::unordered_map<std::thread::id, std::unique_ptr<Buffer>> buffers_;
+            mutable std::mutex mtx_;
+        };
+    }// namespace detail
+
+    // 会话记录器：记录所有进度条的创建、每次 update()/advance()、改标签、完成与销毁，
+    // 用于以真实负载的形态重放并比较渲染吞吐与字节数。
+    // 每个线程把编码后的记录追加到 detail::ThreadLog 中自己的缓冲区（写入无锁），save() 时按时间合并写出。
+    // 同一时刻只能有一个记录器；析构前须确认没有线程仍在更新进度条
+    class SessionRecorder : public BarObserver, public UpdateListener {
+    public:
+        // path 非空时在析构时写出
+        explicit SessionRecorder(const std::string &path = "")
+            : path_(path), origin_(FrameScheduler::now()) {
+            PulseBar::addObserver(this);
+            PulseBar::setUpdateListener(this);
+        }
+
+        // 不能在持有进度条全局锁时析构
+        ~SessionRecorder() override {
+            PulseBar::setUpdateListener(nullptr);
+            PulseBar::removeObserver(this);
+            if (!path_.empty()) save(path_);
+        }
+
+        SessionRecorder(const SessionRecorder &) = delete;
+        SessionRecorder &operator=(const SessionRecorder &) = delete;
+
+        bool save(const std::string &path) const {
+            std::ofstream file(path, std::ios::binary);
+            if (!file) return false;
+            write(file);
+            return static_cast<bool>(file);
+        }
+
+        // 合并各线程的记录，按时间排序后以相对时间差重新编码
+        void write(std::ostream &out) const {
+            std::vector<SessionRecord> records = this->records();
+            std::string data(detail::kSessionMagic, sizeof(detail::kSessionMagic));
+            std::int64_t last_ts = 0;
+            for (const SessionRecord &r : records) detail::encodeRecord(data, r, last_ts);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        }
+
+        // 到目前为止的所有记录，按时间排序；同一线程内的顺序保持不变
+        std::vector<SessionRecord> records() const {
+            std::vector<SessionRecord> records;
+            log_.forEachThread([&](const std::vector<std::string_view> &chunks) {
+                std::int64_t last_ts = 0;
+                for (std::string_view in : chunks) {
+                    SessionRecord r;
+                    while (detail::decodeRecord(in, r, last_ts)) records.push_back(std::move(r));
+                }
+            });
+            std::stable_sort(records.begin(), records.end(), [](const SessionRecord &a, const SessionRecord &b) { return a.ts_ns < b.ts_ns; });
+            return records;
+        }
+
+        void onUpdate(std::uint64_t bar, std::uint64_t count) override {
+            push(RecordType::UPDATE, bar, count);
+        }
+
+        void onAdvance(std::uint64_t bar, std::uint64_t n) override {
+            push(RecordType::ADVANCE, bar, n);
+        }
+
+        void onEvent(BarEvent event, const BarSnapshot &snapshot) override {
+            SessionRecord r;
+            r.bar = snapshot.id;
+            switch (event) {
+                case BarEvent::CREATED:
+                    r.type = RecordType::CREATE;
+                    r.value = snapshot.count;
+                    r.parent = snapshot.parent;
+                    r.total = snapshot.total;
+                    r.width = snapshot.width;
+                    r.label.assign(snapshot.label);
+                    break;
+                case BarEvent::LABEL_CHANGED:
+                    r.type = RecordType::LABEL;
+                    r.label.assign(snapshot.label);
+                    break;
+                case BarEvent::COMPLETED:
+                    r.type = RecordType::COMPLETE;
+                    break;
+                case BarEvent::DESTROYED:
+                    r.type = RecordType::DESTROY;
+                    break;
+            }
+            append(r);
+        }
+
+    private:
+        std::int64_t timestamp() const {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(FrameScheduler::now() - origin_).count();
+        }
+
+        // 热路径：直接编码定长字段，不经过 SessionRecord
+        void push(RecordType type, std::uint64_t bar, std::uint64_t value) {
+            detail::ThreadLog::Buffer &buffer = log_.local();
+            std::int64_t ts = timestamp();
+            std::string &out = buffer.scratch;
+            out.clear();
+            out += static_cast<char>(type);
+            detail::appendVarint(out, static_cast<std::uint64_t>(std::max<std::int64_t>(ts - buffer.last_ts, 0)));
+            buffer.last_ts = std::max(ts, buffer.last_ts);
+            detail::appendVarint(out, bar);
+            detail::appendVarint(out, value);
+            detail::ThreadLog::commit(buffer, out);
+        }
+
+        void append(SessionRecord &r) {
+            detail::ThreadLog::Buffer &buffer = log_.local();
+            r.ts_ns = timestamp();
+            buffer.scratch.clear();
+            detail::encodeRecord(buffer.scratch, r, buffer.last_ts);
+            detail::ThreadLog::commit(buffer, buffer.scratch);
+        }
+
+        std::string path_;
+        FrameScheduler::Clock::time_point origin_;
+        detail::ThreadLog log_;
+    };
+
+    // 读取会话文件；格式错误时返回 false，records 中保留已解码的部分
+    inline bool loadSession(std::istream &in, std::vector<SessionRecord> &records) {
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        if (data.size() < sizeof(detail::kSessionMagic) ||
+            std::memcmp(data.data(), detail::kSessionMagic, sizeof(detail::kSessionMagic)) != 0) {
+            return false;
+        }
+        std::string_view view(data);
+        view.remove_prefix(sizeof(detail::kSessionMagic));
+        std::int64_t last_ts = 0;
+        SessionRecord r;
+        while (!view.empty()) {
+            if (!detail::decodeRecord(view, r, last_ts)) return false;
+            records.push_back(std::move(r));
+        }
+        return true;
+    }
+
+    inline bool loadSession(const std::string &path, std::vector<SessionRecord> &records) {
+        std::ifstream file(path, std::ios::binary);
+        return file && loadSession(file, records);
+    }
+
+    // 按记录重新驱动渲染器，所有进度条都在调用线程上重建。
+    // 每条记录之前以其时刻调用 wait_until，由调用方决定推进手动时钟还是按真实时间等待。
+    // 返回应用的记录数；引用未知进度条的记录被忽略
+    inline std::size_t replaySession(const std::vector<SessionRecord> &records,
+                                     const std::function<void(std::chrono::nanoseconds)> &wait_until) {
+        std::unordered_map<std::uint64_t, std::unique_ptr<PulseBar>> bars;
+        std::size_t applied = 0;
+        for (const SessionRecord &r : records) {
+            auto it = bars.find(r.bar);
+            if (r.type != RecordType::CREATE && it == bars.end()) continue;
+            wait_until(std::chrono::nanoseconds(r.ts_ns));
+            switch (r.type) {
+                case RecordType::CREATE: {
+                    auto bar = std::make_unique<PulseBar>(r.total, r.width, r.label);
+                    auto parent = bars.find(r.parent);
+                    if (parent != bars.end()) bar->setParent(*parent->second);
+                    if (r.value > 0) bar->update(r.value);
+                    bars[r.bar] = std::move(bar);
+                    break;
+                }
+                case RecordType::UPDATE:
+                    it->second->update(r.value);
+                    break;
+                case RecordType::ADVANCE:
+                    it->second->advance(r.value);
+                    break;
+                case RecordType::LABEL:
+                    it->second->setLabel(r.label);
+                    break;
+                case RecordType::COMPLETE:
+                    it->second->complete();
+                    break;
+                case RecordType::DESTROY:
+                    bars.erase(it);
+                    break;
+            }
+            ++applied;
+        }
+        // 记录不完整时按创建的逆序销毁剩余的进度条
+        std::vector<std::pair<std::uint64_t, std::unique_ptr<PulseBar>>> rest;
+        for (auto &entry : bars) rest.emplace_back(entry.first, std::move(entry.second));
+        std::sort(rest.begin(), rest.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        while (!rest.empty()) rest.pop_back();
+        return applied;
+    }
+}// namespace pulse
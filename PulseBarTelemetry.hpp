@@ -0,0 +1,140 @@
+#pragma once
+#include "PulseBar.hpp"
+
+#include <charconv>
+
+namespace pulse {
+    // JSON Lines 遥测：每个节拍为每个进度条追加一行 JSON，
+    // {"ts":...,"id":...,"label":...,"n":...,"total":...,"rate":...,"eta":...,"parent":...}
+    // 一个节拍的所有行拼在复用的缓冲区中，以一次写入交给输出目标；稳定运行时不分配内存。
+    // 节拍线程持有全局锁，只交换缓冲区；写入与 flush 在遥测自己的线程中进行，慢速输出不会阻塞 update()
+    class JsonTelemetry : public BarObserver {
+    public:
+        explicit JsonTelemetry(OutputSink &sink) : sink_(sink) {
+            buffer_.reserve(4096);
+            ready_.reserve(4096);
+            writing_.reserve(4096);
+            writer_ = std::thread([this] { writeLoop(); });
+            PulseBar::addObserver(this);
+        }
+
+        // 不能在持有进度条全局锁时析构；析构前交出的行都会写完
+        ~JsonTelemetry() override {
+            PulseBar::removeObserver(this);
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                stop_ = true;
+            }
+            cv_.notify_all();
+            writer_.join();
+        }
+
+        JsonTelemetry(const JsonTelemetry &) = delete;
+        JsonTelemetry &operator=(const JsonTelemetry &) = delete;
+
+        void onSample(const BarSnapshot &snapshot) override {
+            // 同一节拍内的各行共用一个时间戳
+            if (buffer_.empty()) {
+                ts_ = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            }
+            buffer_ += "{\"ts\":";
+            appendNumber(ts_, 3);
+            buffer_ += ",\"id\":";
+            appendInteger(snapshot.id);
+            buffer_ += ",\"label\":\"";
+            appendEscaped(snapshot.label);
+            buffer_ += "\",\"n\":";
+            appendInteger(snapshot.count);
+            buffer_ += ",\"total\":";
+            appendInteger(snapshot.total);
+            buffer_ += ",\"rate\":";
+            appendNumber(snapshot.rate, 3);
+            buffer_ += ",\"eta\":";
+            appendNumber(snapshot.eta, 3);
+            buffer_ += ",\"parent\":";
+            if (snapshot.parent) {
+                appendInteger(snapshot.parent);
+            } else {
+                buffer_ += "null";
+            }
+            buffer_ += "}\n";
+        }
+
+        void onTickEnd() override {
+            if (buffer_.empty()) return;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                if (ready_.empty()) {
+                    ready_.swap(buffer_);
+                } else {
+                    ready_ += buffer_;// 写线程落后时合并到下一次写入
+                }
+            }
+            buffer_.clear();// 保留容量
+            cv_.notify_one();
+        }
+
+    private:
+        void writeLoop() {
+            std::unique_lock<std::mutex> lk(mtx_);
+            while (true) {
+                cv_.wait(lk, [this] { return stop_ || !ready_.empty(); });
+                if (ready_.empty()) return;
+                writing_.swap(ready_);
+                lk.unlock();
+                sink_.write(writing_.data(), writing_.size());
+                sink_.flush();
+                writing_.clear();
+                lk.lock();
+            }
+        }
+
+        void appendInteger(std::uint64_t value) {
+            char buf[24];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value);
+            buffer_.append(buf, result.ptr);
+        }
+
+        // 非有限值输出为 null
+        void appendNumber(double value, int precision) {
+            if (!std::isfinite(value)) {
+                buffer_ += "null";
+                return;
+            }
+            char buf[64];
+            auto result = std::to_chars(buf, buf + sizeof(buf), value, std::chars_format::fixed, precision);
+            if (result.ec != std::errc()) {
+                buffer_ += "null";
+                return;
+            }
+            buffer_.append(buf, result.ptr);
+        }
+
+        void appendEscaped(std::string_view text) {
+            static constexpr char kHex[] = "0123456789abcdef";
+            for (char c : text) {
+                auto u = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\') {
+                    buffer_ += '\\';
+                    buffer_ += c;
+                } else if (u < 0x20) {
+                    buffer_ += "\\u00";
+                    buffer_ += kHex[u >> 4];
+                    buffer_ += kHex[u & 0xf];
+                } else {
+                    buffer_ += c;
+                }
+            }
+        }
+
+        OutputSink &sink_;
+        std::string buffer_; // 仅节拍线程访问
+        std::string ready_;  // 等待写入，由 mtx_ 保护
+        std::string writing_;// 仅写线程访问
+        double ts_ = 0.0;
+        std::thread writer_;
+        std::mutex mtx_;
+        std::condition_variable cv_;
+        bool stop_ = false;
+    };
+}// namespace pulse
@@ -0,0 +1,269 @@
+#pragma once
+#include "PulseBar.hpp"
+
+namespace pulse::testing {
+    // 无界面的 VT100 屏幕模型：消费进度条的输出字节流，维护最终的屏幕内容，并统计控制序列字节数。
+    // 支持进度条用到的子集：可打印字符（按 UTF-8 码点占一格）、\r、\n、\b、
+    // CSI 光标移动（A/B/C/D/G/H）、擦除（K/J），SGR（m）等其它 CSI 序列只计数不解释。
+    // 屏幕只向下增长不滚动，相当于带完整回滚的终端；超出列宽的字符被截断
+    class VirtualTerminal {
+    public:
+        explicit VirtualTerminal(int columns = 300, bool newline_returns = true)
+            : columns_(columns), newline_returns_(newline_returns) {
+            grid_.emplace_back();
+        }
+
+        void feed(std::string_view bytes) {
+            for (char c: bytes) feedByte(static_cast<unsigned char>(c));
+        }
+
+        // 第 row 行的文本，去掉行尾空白
+        std::string line(int row) const {
+            if (row < 0 || row >= static_cast<int>(grid_.size())) return {};
+            std::string text;
+            for (const std::string &cell: grid_[row]) text += cell.empty() ? " " : cell;
+            while (!text.empty() && text.back() == ' ') text.pop_back();
+            return text;
+        }
+
+        // 所有行，末尾的空行除外
+        std::vector<std::string> lines() const {
+            std::vector<std::string> result;
+            for (int row = 0; row < static_cast<int>(grid_.size()); ++row) result.push_back(line(row));
+            while (!result.empty() && result.back().empty()) result.pop_back();
+            return result;
+        }
+
+        int cursorRow() const { return row_; }
+        int cursorColumn() const { return col_; }
+
+        std::uint64_t totalBytes() const { return total_bytes_; }
+        std::uint64_t escapeBytes() const { return escape_bytes_; }
+        std::uint64_t textBytes() const { return total_bytes_ - escape_bytes_; }
+
+        // 出现过的格式错误或不支持的序列数，正确的输出应为 0
+        std::uint64_t errors() const { return errors_; }
+
+        // 上次调用以来内容被改写或擦除过的行，升序；用于只检查每帧实际改动的行
+        std::vector<int> takeDirtyRows() {
+            std::vector<int> rows;
+            rows.swap(dirty_rows_);
+            for (int row: rows) dirty_[row] = false;
+            std::sort(rows.begin(), rows.end());
+            return rows;
+        }
+
+    private:
+        enum class State {
+            TEXT,
+            ESCAPE,
+            CSI
+        };
+
+        void feedByte(unsigned char c) {
+            ++total_bytes_;
+            switch (state_) {
+                case State::ESCAPE:
+                    ++escape_bytes_;
+                    if (c == '[') {
+                        state_ = State::CSI;
+                        params_.clear();
+                    } else {
+                        ++errors_;
+                        state_ = State::TEXT;
+                    }
+                    return;
+                case State::CSI:
+                    ++escape_bytes_;
+                    if ((c >= '0' && c <= '9') || c == ';' || c == '?') {
+                        params_ += static_cast<char>(c);
+                    } else {
+                        executeCsi(static_cast<char>(c));
+                        state_ = State::TEXT;
+                    }
+                    return;
+                case State::TEXT:
+                    break;
+            }
+
+            if (c == 0x1b) {
+                ++escape_bytes_;
+                flushGlyph();
+                state_ = State::ESCAPE;
+                return;
+            }
+            if (c < 0x20) {
+                ++escape_bytes_;
+                flushGlyph();
+                if (c == '\r') {
+                    col_ = 0;
+                } else if (c == '\n') {
+                    moveRow(row_ + 1);
+                    if (newline_returns_) col_ = 0;
+                } else if (c == '\b') {
+                    col_ = std::max(col_ - 1, 0);
+                } else {
+                    ++errors_;
+                }
+                return;
+            }
+
+            // UTF-8：凑齐一个码点后写入一格
+            if ((c & 0xC0) == 0x80 && !glyph_.empty()) {
+                glyph_ += static_cast<char>(c);
+            } else {
+                flushGlyph();
+                glyph_ += static_cast<char>(c);
+            }
+            if (glyph_.size() >= sequenceLength(static_cast<unsigned char>(glyph_[0]))) flushGlyph();
+        }
+
+        static std::size_t sequenceLength(unsigned char lead) {
+            if (lead >= 0xF0) return 4;
+            if (lead >= 0xE0) return 3;
+            if (lead >= 0xC0) return 2;
+            return 1;
+        }
+
+        void markDirty(int row) {
+            if (static_cast<int>(dirty_.size()) <= row) dirty_.resize(row + 1, false);
+            if (dirty_[row]) return;
+            dirty_[row] = true;
+            dirty_rows_.push_back(row);
+        }
+
+        void flushGlyph() {
+            if (glyph_.empty()) return;
+            if (col_ < columns_) {
+                markDirty(row_);
+                auto &cells = grid_[row_];
+                if (static_cast<int>(cells.size()) <= col_) cells.resize(col_ + 1);
+                cells[col_] = glyph_;
+            }
+            ++col_;
+            glyph_.clear();
+        }
+
+        int param(std::size_t index, int fallback) const {
+            std::size_t start = 0;
+            for (std::size_t i = 0; i < index; ++i) {
+                start = params_.find(';', start);
+                if (start == std::string::npos) return fallback;
+                ++start;
+            }
+            std::size_t end = params_.find(';', start);
+            std::string field = params_.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            if (field.empty() || field[0] == '?') return fallback;
+            return std::stoi(field);
+        }
+
+        void executeCsi(char command) {
+            switch (command) {
+                case 'A':
+                    row_ = std::max(row_ - param(0, 1), 0);
+                    break;
+                case 'B':
+                    moveRow(row_ + param(0, 1));
+                    break;
+                case 'C':
+                    col_ += param(0, 1);
+                    break;
+                case 'D':
+                    col_ = std::max(col_ - param(0, 1), 0);
+                    break;
+                case 'G':
+                    col_ = std::max(param(0, 1) - 1, 0);
+                    break;
+                case 'H':
+                    moveRow(std::max(param(0, 1) - 1, 0));
+                    col_ = std::max(param(1, 1) - 1, 0);
+                    break;
+                case 'K': {
+                    markDirty(row_);
+                    auto &cells = grid_[row_];
+                    int mode = param(0, 0);
+                    if (mode == 0) {
+                        if (static_cast<int>(cells.size()) > col_) cells.resize(col_);
+                    } else if (mode == 1) {
+                        for (int i = 0; i <= col_ && i < static_cast<int>(cells.size()); ++i) cells[i].clear();
+                    } else {
+                        cells.clear();
+                    }
+                    break;
+                }
+                case 'J':
+                    if (param(0, 0) == 2) {
+                        for (int row = 0; row < static_cast<int>(grid_.size()); ++row) markDirty(row);
+                        for (auto &cells: grid_) cells.clear();
+                    } else {
+                        for (int row = row_; row < static_cast<int>(grid_.size()); ++row) markDirty(row);
+                        grid_[row_].resize(std::min<std::size_t>(grid_[row_].size(), col_));
+                        grid_.resize(row_ + 1);
+                    }
+                    break;
+                case 'm':
+                case 'h':
+                case 'l':
+                    break;
+                default:
+                    ++errors_;
+                    break;
+            }
+        }
+
+        void moveRow(int row) {
+            row_ = row;
+            if (static_cast<int>(grid_.size()) <= row_) grid_.resize(row_ + 1);
+        }
+
+        int columns_;
+        bool newline_returns_;
+        std::vector<std::vector<std::string>> grid_;// 每格保存一个 UTF-8 码点
+        int row_ = 0;
+        int col_ = 0;
+        State state_ = State::TEXT;
+        std::string params_;
+        std::string glyph_;
+        std::uint64_t total_bytes_ = 0;
+        std::uint64_t escape_bytes_ = 0;
+        std::uint64_t errors_ = 0;
+        std::vector<bool> dirty_;
+        std::vector<int> dirty_rows_;
+    };
+
+    // 手动推进的时钟，配合 PulseBar::setClock() 使用，让测试与基准不依赖 sleep 重放精确的时间序列。
+    // 起点设在一小时处，使默认构造的时间点都落在过去
+    class ManualClock : public ClockSource {
+    public:
+        using duration = std::chrono::steady_clock::duration;
+        using time_point = std::chrono::steady_clock::time_point;
+
+        time_point now() const override {
+            return time_point(duration(ticks_.load(std::memory_order_relaxed)));
+        }
+
+        void advance(duration d) { ticks_.fetch_add(d.count(), std::memory_order_relaxed); }
+        void advanceSeconds(double seconds) {
+            advance(std::chrono::duration_cast<duration>(std::chrono::duration<double>(seconds)));
+        }
+        void set(time_point t) { ticks_.store(t.time_since_epoch().count(), std::memory_order_relaxed); }
+
+    private:
+        std::atomic<duration::rep> ticks_{std::chrono::duration_cast<duration>(std::chrono::hours(1)).count()};
+    };
+
+    // 直接把输出喂给 VirtualTerminal 的输出目标
+    class ScreenSink : public OutputSink {
+    public:
+        explicit ScreenSink(VirtualTerminal &terminal) : terminal_(terminal) {}
+
+        void write(const char *data, std::size_t size) override {
+            terminal_.feed(std::string_view(data, size));
+        }
+
+        void flush() override {}
+
+    private:
+        VirtualTerminal &terminal_;
+    };
+}// namespace pulse::testing
@@ -0,0 +1,137 @@
+#pragma once
+#include "PulseBar.hpp"
+
+#include <fstream>
+#include <unordered_set>
+
+namespace pulse {
+    // Chrome Trace Event / Perfetto 格式的记录器：进度条创建、改标签、完成等事件以及节拍采样
+    // 按发生顺序追加到一个事件列表，析构或 save() 时输出为 JSON。
+    // 每个进度条在查看器中占一条轨道：每个标签阶段是一个切片，进度是一条计数器轨道
+    class TraceRecorder : public BarObserver {
+    public:
+        // path 非空时在析构时写出
+        explicit TraceRecorder(const std::string &path = "")
+            : path_(path), origin_(FrameScheduler::now()) {
+            PulseBar::addObserver(this);
+        }
+
+        // 不能在持有进度条全局锁时析构
+        ~TraceRecorder() override {
+            PulseBar::removeObserver(this);
+            if (!path_.empty()) save(path_);
+        }
+
+        TraceRecorder(const TraceRecorder &) = delete;
+        TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+        bool save(const std::string &path) const {
+            std::ofstream file(path, std::ios::binary);
+            if (!file) return false;
+            write(file);
+            return static_cast<bool>(file);
+        }
+
+        void write(std::ostream &out) const {
+            std::vector<Event> events;
+            {
+                auto lock = lockCallbacks();
+                events = events_;
+            }
+
+            out << "{\"traceEvents\":[\n";
+            out << R"({"name":"process_name","ph":"M","pid":1,"tid":0,"args":{"name":"PulseBar"}})";
+            char ts[32];
+            for (const Event &e : events) {
+                std::snprintf(ts, sizeof(ts), "%.3f", static_cast<double>(e.ts_ns) / 1000.0);
+                out << ",\n{\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << e.bar << ",\"ts\":" << ts;
+                switch (e.phase) {
+                    case 'M':
+                        out << R"(,"name":"thread_name","args":{"name":")";
+                        writeEscaped(out, e.name);
+                        out << "\"}}";
+                        break;
+                    case 'B':
+                        out << ",\"name\":\"";
+                        writeEscaped(out, e.name);
+                        out << "\"}";
+                        break;
+                    case 'C':
+                        out << ",\"name\":\"progress #" << e.bar << "\",\"args\":{\"n\":" << e.count << "}}";
+                        break;
+                    default:
+                        out << "}";
+                        break;
+                }
+            }
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+
+        void onSample(const BarSnapshot &snapshot) override {
+            if (!snapshot.completed) push('C', snapshot);
+        }
+
+        void onEvent(BarEvent event, const BarSnapshot &snapshot) override {
+            switch (event) {
+                case BarEvent::CREATED:
+                    push('M', snapshot);
+                    push('B', snapshot);
+                    push('C', snapshot);
+                    break;
+                case BarEvent::LABEL_CHANGED:
+                    push('E', snapshot);
+                    push('B', snapshot);
+                    break;
+                case BarEvent::COMPLETED:
+                    push('C', snapshot);
+                    push('E', snapshot);
+                    break;
+                case BarEvent::DESTROYED:
+                    if (!snapshot.completed) push('E', snapshot);
+                    break;
+            }
+        }
+
+    private:
+        struct Event {
+            std::int64_t ts_ns;
+            std::uint64_t bar;
+            std::uint64_t count;
+            char phase;
+            std::string name;// 仅 M/B 事件使用
+        };
+
+        // 回调都在进度条全局锁下执行，事件列表由这把锁保护
+        void push(char phase, const BarSnapshot &snapshot) {
+            // 记录器挂上之前就已存在的进度条没有对应的 B，不输出孤立的 E
+            if (phase == 'B') open_slices_.insert(snapshot.id);
+            if (phase == 'E' && open_slices_.erase(snapshot.id) == 0) return;
+            Event &e = events_.emplace_back();
+            e.ts_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(FrameScheduler::now() - origin_).count();
+            e.bar = snapshot.id;
+            e.count = snapshot.count;
+            e.phase = phase;
+            if (phase == 'M' || phase == 'B') e.name.assign(snapshot.label);
+        }
+
+        static void writeEscaped(std::ostream &out, const std::string &text) {
+            for (char c : text) {
+                auto u = static_cast<unsigned char>(c);
+                if (c == '"' || c == '\\') {
+                    out << '\\' << c;
+                } else if (u < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", u);
+                    out << buf;
+                } else {
+                    out << c;
+                }
+            }
+        }
+
+        std::string path_;
+        FrameScheduler::Clock::time_point origin_;
+        std::vector<Event> events_;
+        std::unordered_set<std::uint64_t> open_slices_;
+    };
+}// namespace pulse
@@ -0,0 +1,346 @@
+#include "PulseBarAlgorithm.hpp"
+#include "PulseBarRanges.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// PulseBar 微基准：结果以 JSON 输出到 stdout，便于跨版本追踪回归。
+//   pulsebar_bench [--quick]
+// --quick 把迭代次数缩小 100 倍，用于冒烟测试
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // 丢弃输出，只统计字节数，避免终端本身的开销混入结果
+    class NullSink : public pulse::OutputSink {
+    public:
+        void write(const char * /*data*/, std::size_t size) override { bytes_ += size; }
+        void flush() override {}
+        std::uint64_t bytes() const { return bytes_; }
+
+    private:
+        std::uint64_t bytes_ = 0;
+    };
+
+    // 阻止编译器把空循环优化掉
+    template<typename T>
+    inline void doNotOptimize(T const &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile T sink;
+        sink = value;
+#endif
+    }
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // 逐条追加 JSON 结果
+    class JsonReport {
+    public:
+        void begin(const std::string &name) {
+            out_ << (first_ ? "\n" : ",\n") << "    {\"name\":\"" << name << "\"";
+            first_ = false;
+        }
+        template<typename T>
+        JsonReport &field(const char *key, const T &value) {
+            out_ << ",\"" << key << "\":";
+            if constexpr (std::is_convertible_v<T, std::string_view>) {
+                out_ << '"' << value << '"';
+            } else {
+                out_ << value;
+            }
+            return *this;
+        }
+        void end() { out_ << "}"; }
+        std::string str() const { return "{\n  \"benchmarks\":[" + out_.str() + "\n  ]\n}\n"; }
+
+    private:
+        std::ostringstream out_;
+        bool first_ = true;
+    };
+
+    enum class Op {
+        UPDATE,
+        INCREMENT,
+        ADVANCE
+    };
+
+    const char *opName(Op op) {
+        switch (op) {
+            case Op::UPDATE:
+                return "update";
+            case Op::INCREMENT:
+                return "operator++";
+            case Op::ADVANCE:
+                return "advance";
+        }
+        return "";
+    }
+
+    void runOp(pulse::PulseBar &bar, Op op, std::uint64_t iters) {
+        switch (op) {
+            case Op::UPDATE:
+                for (std::uint64_t i = 1; i <= iters; ++i) bar.update(i);
+                break;
+            case Op::INCREMENT:
+                for (std::uint64_t i = 0; i < iters; ++i) ++bar;
+                break;
+            case Op::ADVANCE:
+                for (std::uint64_t i = 0; i < iters; i += 64) bar.advance(64);
+                break;
+        }
+    }
+
+    // 热路径每次调用的耗时；shared 为所有线程共用一个进度条，否则每个线程一个
+    void benchHotPath(JsonReport &report, Op op, int threads, bool shared, std::uint64_t iters_per_thread) {
+        std::uint64_t total = iters_per_thread * static_cast<std::uint64_t>(threads);
+        std::vector<std::unique_ptr<pulse::PulseBar>> bars;
+        for (int i = 0; i < (shared ? 1 : threads); ++i) {
+            bars.push_back(std::make_unique<pulse::PulseBar>(shared ? total : iters_per_thread, "bench"));
+        }
+        std::vector<std::thread> workers;
+        auto start = Clock::now();
+        for (int t = 0; t < threads; ++t) {
+            pulse::PulseBar &bar = *bars[shared ? 0 : t];
+            workers.emplace_back([&bar, op, iters_per_thread] { runOp(bar, op, iters_per_thread); });
+        }
+        for (auto &worker: workers) worker.join();
+        double seconds = secondsSince(start);
+        for (auto &bar: bars) bar->complete();
+
+        // 以墙钟时间除以所有线程的调用总数；advance(64) 每次调用覆盖 64 项，按调用次数计
+        std::uint64_t calls = op == Op::ADVANCE ? (total + 63) / 64 : total;
+        report.begin("hot_path");
+        report.field("op", opName(op))
+                .field("threads", threads)
+                .field("layout", shared ? "shared" : "separate")
+                .field("calls", calls)
+                .field("ns_per_op", seconds * 1e9 / static_cast<double>(calls));
+        report.end();
+    }
+
+    // 每次更新都产生可见变化且不限帧率，由开销统计得到每帧构建耗时与字节数
+    void benchFrameBuild(JsonReport &report, const char *theme_name, int width,
+                         const std::function<void(pulse::PulseBar &)> &configure, NullSink &sink) {
+        constexpr std::uint64_t kFrames = 2000;
+        pulse::FrameScheduler &scheduler = pulse::FrameScheduler::instance();
+        pulse::OverheadStats before = pulse::stats();
+        std::uint64_t bytes_before = sink.bytes();
+        {
+            pulse::PulseBar bar(kFrames, width, "frame");
+            bar.setMinInterval(0);
+            configure(bar);
+            for (std::uint64_t i = 1; i <= kFrames; ++i) {
+                bar.setLabel(i % 2 ? "frame" : "Frame");// 保证每次都有可见变化
+                bar.update(i);
+            }
+            bar.complete();
+        }
+        scheduler.flush();
+        pulse::OverheadStats after = pulse::stats();
+        std::uint64_t frames = after.frames_built - before.frames_built;
+        std::uint64_t written = after.frames_written - before.frames_written;
+        report.begin("frame_build");
+        report.field("theme", theme_name)
+                .field("width", width)
+                .field("frames", frames)
+                .field("build_ns_per_frame", frames ? static_cast<double>(after.build_ns - before.build_ns) / frames : 0.0)
+                .field("bytes_per_frame", written ? static_cast<double>(sink.bytes() - bytes_before) / written : 0.0);
+        report.end();
+    }
+
+    // 与同样迭代次数的空循环相比，每次迭代多出的耗时
+    void benchEndToEnd(JsonReport &report, std::uint64_t iters) {
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < iters; ++i) doNotOptimize(i);
+        double bare = secondsSince(start);
+
+        pulse::PulseBar bar(iters, "e2e");
+        start = Clock::now();
+        for (std::uint64_t i = 0; i < iters; ++i) {
+            doNotOptimize(i);
+            ++bar;
+        }
+        bar.complete();
+        double with_bar = secondsSince(start);
+
+        report.begin("end_to_end");
+        report.field("iterations", iters)
+                .field("bare_seconds", bare)
+                .field("bar_seconds", with_bar)
+                .field("overhead_ns_per_iter", (with_bar - bare) * 1e9 / static_cast<double>(iters));
+        report.end();
+    }
+
+    // 对 std::vector<int> 求和：手写循环、逐项的 pulse::track() 与按块的 pulse::track_chunks()。
+    // 逐项包装的循环无法向量化，应与禁止向量化的手写循环 bare_scalar 对照
+    void benchTrackedLoop(JsonReport &report, std::size_t size) {
+        std::vector<int> items(size, 1);
+        auto measure = [&](const char *variant, auto &&loop) {
+            doNotOptimize(loop());// 预热缓存
+            auto start = Clock::now();
+            long long sum = loop();
+            double seconds = secondsSince(start);
+            doNotOptimize(sum);
+            report.begin("tracked_loop");
+            report.field("variant", variant)
+                    .field("elements", size)
+                    .field("ns_per_element", seconds * 1e9 / static_cast<double>(size));
+            report.end();
+        };
+        measure("bare", [&] {
+            long long sum = 0;
+            for (int x: items) sum += x;
+            return sum;
+        });
+        measure("bare_scalar", [&] {
+            long long sum = 0;
+            for (int x: items) {
+                sum += x;
+                doNotOptimize(sum);
+            }
+            return sum;
+        });
+        measure("track", [&] {
+            long long sum = 0;
+            for (int x: pulse::track(items, "track")) sum += x;
+            return sum;
+        });
+        measure("track_chunks", [&] {
+            long long sum = 0;
+            for (auto block: pulse::track_chunks(items, 0, "chunks")) {
+                for (int x: block) sum += x;
+            }
+            return sum;
+        });
+    }
+
+    // 多线程拆分 N 项：手写线程逐项推进共享进度条 vs parallel_for 按块汇总
+    void benchParallelFor(JsonReport &report, std::uint64_t items) {
+        const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        auto work = [](std::uint64_t i) {
+            std::uint64_t x = i * 0x9E3779B97F4A7C15ull;
+            for (int k = 0; k < 8; ++k) x ^= x >> 13, x *= 0xff51afd7ed558ccdull;
+            doNotOptimize(x);
+        };
+        auto splitThreads = [&](auto &&body) {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    std::uint64_t end = items * (t + 1) / threads;
+                    for (std::uint64_t i = items * t / threads; i < end; ++i) body(i);
+                });
+            }
+            for (auto &worker: workers) worker.join();
+        };
+        auto measure = [&](const char *variant, auto &&run) {
+            auto start = Clock::now();
+            run();
+            double seconds = secondsSince(start);
+            report.begin("parallel_for");
+            report.field("variant", variant)
+                    .field("threads", threads)
+                    .field("items", items)
+                    .field("ns_per_item", seconds * 1e9 / static_cast<double>(items));
+            report.end();
+        };
+        measure("bare_threads", [&] { splitThreads(work); });
+        measure("threads_advance", [&] {
+            pulse::PulseBar bar(items, "threads");
+            splitThreads([&](std::uint64_t i) {
+                work(i);
+                bar.advance();
+            });
+            bar.complete();
+        });
+        measure("parallel_for", [&] { pulse::parallel_for(std::uint64_t{0}, items, 0, work, "parallel_for"); });
+    }
+
+    // 标准并行算法与带进度包装的对比，overhead_pct 为相对裸算法的额外耗时（取三次中最快的一次）
+    void benchStdAlgorithm(JsonReport &report, std::size_t size) {
+        std::vector<std::uint64_t> items(size);
+        std::iota(items.begin(), items.end(), std::uint64_t{0});
+        auto mix = [](std::uint64_t x) {
+            for (int k = 0; k < 8; ++k) x ^= x >> 13, x *= 0xff51afd7ed558ccdull;
+            return x;
+        };
+        auto best = [](auto &&run) {
+            double fastest = 1e300;
+            for (int round = 0; round < 3; ++round) {
+                auto start = Clock::now();
+                run();
+                fastest = std::min(fastest, secondsSince(start));
+            }
+            return fastest;
+        };
+        auto measure = [&](const char *algorithm, auto &&bare, auto &&tracked) {
+            double bare_seconds = best(bare);
+            double tracked_seconds = best(tracked);
+            report.begin("std_algorithm");
+            report.field("algorithm", algorithm)
+                    .field("elements", size)
+                    .field("bare_ns_per_element", bare_seconds * 1e9 / static_cast<double>(size))
+                    .field("tracked_ns_per_element", tracked_seconds * 1e9 / static_cast<double>(size))
+                    .field("overhead_pct", (tracked_seconds / bare_seconds - 1.0) * 100.0);
+            report.end();
+        };
+        measure("for_each", [&] {
+            std::for_each(std::execution::par, items.begin(), items.end(), [&](std::uint64_t &x) { x = mix(x); });
+        }, [&] {
+            pulse::PulseBar bar(size, "for_each");
+            pulse::for_each(std::execution::par, items.begin(), items.end(), [&](std::uint64_t &x) { x = mix(x); }, bar);
+            bar.complete();
+        });
+        measure("transform_reduce", [&] {
+            doNotOptimize(std::transform_reduce(std::execution::par, items.begin(), items.end(), std::uint64_t{0}, std::bit_xor<>(), mix));
+        }, [&] {
+            pulse::PulseBar bar(size, "transform_reduce");
+            doNotOptimize(pulse::transform_reduce(std::execution::par, items.begin(), items.end(), std::uint64_t{0}, std::bit_xor<>(), mix, bar));
+            bar.complete();
+        });
+    }
+}// namespace
+
+int main(int argc, char **argv) {
+    std::uint64_t scale = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--quick") scale = 100;
+    }
+
+    NullSink sink;
+    pulse::PulseBar::setOutputSink(&sink);
+    pulse::FrameScheduler::instance().setMaxFps(0);
+    JsonReport report;
+
+    for (Op op: {Op::UPDATE, Op::INCREMENT, Op::ADVANCE}) {
+        for (int threads: {1, 2, 8, 32, 64}) {
+            for (bool shared: {true, false}) {
+                if (threads == 1 && !shared) continue;
+                benchHotPath(report, op, threads, shared, 64000000 / scale / threads);
+            }
+        }
+    }
+
+    static const pulse::StaticTheme<40, pulse::ColorType::BRIGHT_BLUE, pulse::ColorType::BRIGHT_CYAN, pulse::ColorType::BRIGHT_GREEN> static_theme;
+    for (int width: {20, 50, 100, 200}) {
+        benchFrameBuild(report, "default", width, [](pulse::PulseBar &) {}, sink);
+        benchFrameBuild(report, "solid", width, [](pulse::PulseBar &bar) { bar.setAnimation(&pulse::solidBlockAnimation); }, sink);
+    }
+    benchFrameBuild(report, "static", 40, [](pulse::PulseBar &bar) { bar.setTheme(&static_theme); }, sink);
+
+    for (std::uint64_t iters: {1000000ull, 100000000ull, 1000000000ull}) {
+        benchEndToEnd(report, std::max<std::uint64_t>(iters / scale, 1));
+    }
+
+    benchTrackedLoop(report, (std::size_t{1} << 26) / scale);
+    benchParallelFor(report, 64000000 / scale);
+    benchStdAlgorithm(report, 16000000 / scale);
+
+    pulse::PulseBar::setOutputSink(nullptr);
+    std::cout << report.str();
+    return 0;
+}
@@ -0,0 +1,225 @@
+#include "PulseBar.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <termios.h>
+#if defined(__APPLE__)
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+// 伪终端端到端基准：进度条输出写入 openpty() 的从端，读线程从主端读出，模拟真实终端。
+// 统计字节数、write 调用次数、从 update() 到读端收到反映该更新的帧的延迟，以及终端来不及读时 write 被阻塞的情况。
+// 从端设为 raw 模式，避免 ONLCR 把 \n 展开为 \r\n 使读端的字节偏移与写出的帧错位
+//   pulsebar_pty_bench [--bars N] [--iters N] [--work-ns N] [--bps N] [--fps N]
+// --bps 限制读端每秒读取的字节数，模拟慢速 SSH 链路；0 表示不限制
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::int64_t nowNs() {
+        return pulse::detail::toNanos(Clock::now());
+    }
+
+    // 写入 pty 从端的输出目标；每帧恰好一次 write + flush，在 flush 时写出并记录帧的结束偏移。
+    // 工作线程在每次更新前调用 markUpdate()，帧以尚未显示的最早一次更新的时刻为起点
+    class PtySink : public pulse::OutputSink {
+    public:
+        explicit PtySink(int fd) : fd_(fd) {}
+
+        void markUpdate() {
+            if (unrendered_update_ns_.load(std::memory_order_relaxed) != 0) return;
+            std::int64_t expected = 0;
+            unrendered_update_ns_.compare_exchange_strong(expected, nowNs(), std::memory_order_relaxed);
+        }
+
+        void write(const char *data, std::size_t size) override {
+            if (buffer_.empty()) frame_start_ns_ = unrendered_update_ns_.exchange(0, std::memory_order_relaxed);
+            buffer_.append(data, size);
+        }
+
+        void flush() override {
+            if (buffer_.empty()) return;
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                written_ += buffer_.size();
+                pending_.emplace_back(written_, frame_start_ns_);
+            }
+            ++frames_;
+            const char *data = buffer_.data();
+            std::size_t size = buffer_.size();
+            while (size > 0) {
+                std::int64_t start = nowNs();
+                ssize_t n = ::write(fd_, data, size);
+                std::int64_t blocked = nowNs() - start;
+                ++write_calls_;
+                // 超过 1ms 视为读端来不及消费造成的背压
+                if (blocked > 1000000) {
+                    ++stalls_;
+                    stall_ns_ += blocked;
+                }
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    break;
+                }
+                data += n;
+                size -= static_cast<std::size_t>(n);
+            }
+            buffer_.clear();
+        }
+
+        // 读端累计收到 received 字节后，结算已完整到达的帧的延迟；不由更新引起的帧（换行等）不计入
+        void onReceived(std::uint64_t received, std::int64_t now_ns) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            while (!pending_.empty() && pending_.front().first <= received) {
+                if (pending_.front().second != 0) {
+                    latency_.record(static_cast<std::uint64_t>(now_ns - pending_.front().second));
+                }
+                pending_.pop_front();
+            }
+        }
+
+        std::uint64_t frames() const { return frames_; }
+        std::uint64_t writeCalls() const { return write_calls_; }
+        std::uint64_t stalls() const { return stalls_; }
+        std::int64_t stallNs() const { return stall_ns_; }
+        pulse::LatencyHistogram::Snapshot latency() const { return latency_.snapshot(); }
+
+    private:
+        int fd_;
+        std::string buffer_;
+        std::atomic<std::int64_t> unrendered_update_ns_{0};// 0 表示所有更新都已进入帧
+        std::int64_t frame_start_ns_ = 0;
+        std::uint64_t frames_ = 0;
+        std::uint64_t write_calls_ = 0;
+        std::uint64_t stalls_ = 0;
+        std::int64_t stall_ns_ = 0;
+        std::mutex mtx_;
+        std::uint64_t written_ = 0;
+        std::deque<std::pair<std::uint64_t, std::int64_t>> pending_;// 帧结束偏移, 引起该帧的更新时刻
+        pulse::LatencyHistogram latency_;
+    };
+
+    void spin(std::int64_t ns) {
+        std::int64_t until = nowNs() + ns;
+        while (nowNs() < until) {
+        }
+    }
+
+    std::uint64_t argValue(int argc, char **argv, const char *name, std::uint64_t fallback) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string_view(argv[i]) == name) return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        return fallback;
+    }
+}// namespace
+
+int main(int argc, char **argv) {
+    const int bars = static_cast<int>(argValue(argc, argv, "--bars", 4));
+    const std::uint64_t iters = argValue(argc, argv, "--iters", 200000);
+    const std::int64_t work_ns = static_cast<std::int64_t>(argValue(argc, argv, "--work-ns", 1000));
+    const std::uint64_t bps = argValue(argc, argv, "--bps", 0);
+    const std::uint64_t fps = argValue(argc, argv, "--fps", 30);
+
+    int master = -1;
+    int slave = -1;
+    winsize size{};
+    size.ws_row = 50;
+    size.ws_col = 160;
+    if (::openpty(&master, &slave, nullptr, nullptr, &size) != 0) {
+        std::perror("openpty");
+        return 1;
+    }
+    termios tio{};
+    if (::tcgetattr(slave, &tio) == 0) {
+        ::cfmakeraw(&tio);
+        ::tcsetattr(slave, TCSANOW, &tio);
+    }
+
+    PtySink sink(slave);
+    pulse::PulseBar::setOutputSink(&sink);
+    pulse::FrameScheduler::instance().setMaxFps(static_cast<double>(fps));
+
+    // 读线程：按 --bps 节流地读取主端
+    std::atomic<bool> done{false};
+    std::uint64_t received = 0;
+    std::thread reader([&] {
+        char buf[4096];
+        std::int64_t start = nowNs();
+        while (true) {
+            std::size_t chunk = sizeof(buf);
+            if (bps > 0) {
+                // 令牌桶：只读取到当前时刻允许的字节数
+                auto allowed = static_cast<std::uint64_t>(static_cast<double>(nowNs() - start) * 1e-9 * static_cast<double>(bps));
+                if (allowed <= received) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    continue;
+                }
+                chunk = std::min<std::size_t>(chunk, allowed - received);
+            }
+            pollfd pfd{master, POLLIN, 0};
+            if (::poll(&pfd, 1, 50) <= 0) {
+                if (done.load()) break;
+                continue;
+            }
+            ssize_t n = ::read(master, buf, chunk);
+            if (n <= 0) break;
+            received += static_cast<std::uint64_t>(n);
+            sink.onReceived(received, nowNs());
+        }
+    });
+
+    auto start = Clock::now();
+    {
+        std::vector<std::thread> workers;
+        for (int b = 0; b < bars; ++b) {
+            workers.emplace_back([b, iters, work_ns, &sink] {
+                pulse::PulseBar bar(iters, 40, "worker " + std::to_string(b));
+                for (std::uint64_t i = 0; i < iters; ++i) {
+                    spin(work_ns);
+                    sink.markUpdate();
+                    ++bar;
+                }
+                sink.markUpdate();
+                bar.complete();
+            });
+        }
+        for (auto &worker: workers) worker.join();
+    }
+    pulse::FrameScheduler::instance().flush();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // 等读端读完剩余输出
+    done.store(true);
+    reader.join();
+    pulse::PulseBar::setOutputSink(nullptr);
+    ::close(slave);
+    ::close(master);
+
+    pulse::OverheadStats stats = pulse::stats();
+    pulse::LatencyHistogram::Snapshot latency = sink.latency();
+    std::cout << "{\"bars\":" << bars
+              << ",\"iters\":" << iters
+              << ",\"work_ns\":" << work_ns
+              << ",\"reader_bps\":" << bps
+              << ",\"max_fps\":" << fps
+              << ",\"seconds\":" << seconds
+              << ",\"ideal_seconds\":" << static_cast<double>(iters) * static_cast<double>(work_ns) * 1e-9
+              << ",\"bytes\":" << received
+              << ",\"frames\":" << sink.frames()
+              << ",\"write_calls\":" << sink.writeCalls()
+              << ",\"bytes_per_frame\":" << (sink.frames() ? static_cast<double>(received) / static_cast<double>(sink.frames()) : 0.0)
+              << ",\"latency_p50_ns\":" << latency.percentile(50)
+              << ",\"latency_p99_ns\":" << latency.percentile(99)
+              << ",\"latency_max_ns\":" << latency.percentile(100)
+              << ",\"stalls\":" << sink.stalls()
+              << ",\"stall_ns\":" << sink.stallNs()
+              << ",\"build_ns\":" << stats.build_ns
+              << ",\"deduped_writes\":" << stats.deduped_writes
+              << "}\n";
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "PulseBarRecord.hpp"
+#include "PulseBarTesting.hpp"
+#include <cstdlib>
+#include <iostream>
+
+// 重放 SessionRecorder 记录的会话，用真实负载的形态比较渲染吞吐与输出字节数。
+//   pulsebar_replay FILE [--realtime] [--out null|stdout|tty|PATH] [--fps N]
+// 默认尽快重放：用手动时钟把时间推进到每条记录的时刻，输出与按真实速度重放逐字节相同且可复现；
+// --realtime 按记录的真实间隔等待。结果以 JSON 输出到 stdout（--out stdout 时输出到 stderr）
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // 丢弃输出，字节数由开销统计得到
+    class NullSink : public pulse::OutputSink {
+    public:
+        void write(const char *, std::size_t) override {}
+        void flush() override {}
+    };
+
+    const char *argString(int argc, char **argv, const char *name, const char *fallback) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string_view(argv[i]) == name) return argv[i + 1];
+        }
+        return fallback;
+    }
+
+    bool hasFlag(int argc, char **argv, const char *name) {
+        for (int i = 1; i < argc; ++i) {
+            if (std::string_view(argv[i]) == name) return true;
+        }
+        return false;
+    }
+}// namespace
+
+int main(int argc, char **argv) {
+    if (argc < 2 || argv[1][0] == '-') {
+        std::cerr << "usage: pulsebar_replay FILE [--realtime] [--out null|stdout|tty|PATH] [--fps N]\n";
+        return 2;
+    }
+    std::vector<pulse::SessionRecord> records;
+    if (!pulse::loadSession(argv[1], records)) {
+        std::cerr << "pulsebar_replay: cannot read session " << argv[1] << "\n";
+        return 1;
+    }
+
+    const bool realtime = hasFlag(argc, argv, "--realtime");
+    const std::string out = argString(argc, argv, "--out", "null");
+    const double fps = std::strtod(argString(argc, argv, "--fps", "30"), nullptr);
+
+    std::unique_ptr<pulse::OutputSink> sink;
+    std::FILE *file = nullptr;
+    if (out == "null") {
+        sink = std::make_unique<NullSink>();
+    } else if (out == "stdout") {
+        sink = std::make_unique<pulse::FdSink>(1);
+    } else if (out == "tty") {
+        sink = std::make_unique<pulse::TtySink>();
+    } else {
+        file = std::fopen(out.c_str(), "wb");
+        if (!file) {
+            std::cerr << "pulsebar_replay: cannot open " << out << "\n";
+            return 1;
+        }
+        sink = std::make_unique<pulse::FileSink>(file);
+    }
+    pulse::PulseBar::setOutputSink(sink.get());
+    pulse::FrameScheduler::instance().setMaxFps(fps);
+
+    pulse::testing::ManualClock clock;
+    if (!realtime) pulse::PulseBar::setClock(&clock);
+    const auto session_start = clock.now();
+
+    pulse::OverheadStats before = pulse::stats();
+    auto start = Clock::now();
+    std::size_t applied = pulse::replaySession(records, [&](std::chrono::nanoseconds at) {
+        if (realtime) {
+            std::this_thread::sleep_until(start + at);
+        } else {
+            clock.set(session_start + at);
+        }
+    });
+    pulse::FrameScheduler::instance().flush();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    pulse::OverheadStats after = pulse::stats();
+
+    pulse::PulseBar::setOutputSink(nullptr);
+    pulse::PulseBar::setClock(nullptr);
+    sink.reset();
+    if (file) std::fclose(file);
+
+    std::uint64_t frames = after.frames_written - before.frames_written;
+    std::uint64_t bytes = after.bytes_written - before.bytes_written;
+    double session_seconds = records.empty() ? 0.0 : static_cast<double>(records.back().ts_ns) * 1e-9;
+    (out == "stdout" ? std::cerr : std::cout)
+            << "{\"records\":" << records.size()
+            << ",\"applied\":" << applied
+            << ",\"mode\":\"" << (realtime ? "realtime" : "fast") << "\""
+            << ",\"session_seconds\":" << session_seconds
+            << ",\"replay_seconds\":" << seconds
+            << ",\"records_per_second\":" << (seconds > 0 ? static_cast<double>(applied) / seconds : 0.0)
+            << ",\"frames\":" << frames
+            << ",\"bytes\":" << bytes
+            << ",\"bytes_per_frame\":" << (frames ? static_cast<double>(bytes) / static_cast<double>(frames) : 0.0)
+            << ",\"build_ns\":" << after.build_ns - before.build_ns
+            << ",\"write_ns\":" << after.write_ns - before.write_ns
+            << "}\n";
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "PulseBar.hpp"
+#include "PulseBarParallel.hpp"
 #include <iostream>
 #include <thread>
 #include <vector>
@@ -83,7 +84,6 @@ void example_nested() {
     main_bar.complete();
 }
 
-//todo 修复多线程的只能显示一个的问题
 // 示例4: 多线程
 void example_multithreaded() {
     auto worker_task = [](int id, int total_work) {
@@ -138,6 +138,30 @@ void example_milliseconds_time() {
     bar.complete();
 }
 
+// 示例7: 编译期预渲染主题
+void example_static_theme() {
+    static const pulse::StaticTheme<40, pulse::ColorType::BRIGHT_BLUE, pulse::ColorType::BRIGHT_CYAN,
+                                        pulse::ColorType::BRIGHT_GREEN>
+            theme;
+    pulse::PulseBar bar(100, "静态主题");
+    bar.setTheme(&theme);
+    for (int i = 0; i <= 100; ++i) {
+        bar.update(i);
+        std::this_thread::sleep_for(20ms);
+    }
+    bar.complete();
+}
+
+// 示例8: 工作窃取的 parallel_for，总进度条下显示各分区的子进度条
+void example_parallel_for() {
+    pulse::ParallelOptions options;
+    options.worker_bars = true;
+    pulse::parallel_for(0, 400, 10, [](int i) {
+        // 前面的项更慢，空闲线程会把它们偷走
+        std::this_thread::sleep_for(i < 100 ? 20ms : 5ms);
+    }, "并行处理", options);
+}
+
 int main() {
     std::cout << "=== 示例1: 基本用法 ===\n";
     example_basic();
@@ -157,6 +181,12 @@ int main() {
     std::cout << "\n=== 示例6: 毫秒时间格式 ===\n";
     example_milliseconds_time();
 
+    std::cout << "\n=== 示例7: 静态主题 ===\n";
+    example_static_theme();
+
+    std::cout << "\n=== 示例8: parallel_for ===\n";
+    example_parallel_for();
+
     std::cout << "\n所有示例运行完成!\n";
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,16 @@
+#include "test_framework.hpp"
+#include <cstring>
+
+// 运行全部用例；传入参数时只运行名字包含该参数的用例
+int main(int argc, char **argv) {
+    int run = 0;
+    for (const auto &test: pulse_test::registry()) {
+        if (argc > 1 && !std::strstr(test.name, argv[1])) continue;
+        int before = pulse_test::failures();
+        test.fn();
+        ++run;
+        std::fprintf(stderr, "[%s] %s\n", pulse_test::failures() == before ? "  OK  " : "FAILED", test.name);
+    }
+    std::fprintf(stderr, "%d tests, %d failures\n", run, pulse_test::failures());
+    return pulse_test::failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,301 @@
+#include "PulseBarTesting.hpp"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+// 多线程压力测试：数百个线程随机地创建、推进、改标签、嵌套和销毁进度条，同时并发推进几个共享进度条。
+//   pulsebar_stress [--threads N] [--bars N] [--shared-iters N] [--fps N] [--seed N] [--verify 0|1]
+// 检查的不变量：
+//   - 计数不丢失：自有进度条销毁前的计数等于本线程的推进量之和，共享进度条的最终计数等于所有线程之和
+//   - 输出单调：每个进度条显示的百分比从不回退
+//   - 行归属：每个进度条始终只出现在同一行，每一行只属于一个进度条，输出中没有格式错误
+// 结果以 JSON 输出到 stdout，有违例时返回 1。可在 -DPULSEBAR_SANITIZE=thread 构建下运行
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t argValue(int argc, char **argv, const char *name, std::uint64_t fallback) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string_view(argv[i]) == name) return std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        return fallback;
+    }
+
+    std::uint64_t elapsedNs(Clock::time_point start) {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    // 违例记录，只保留前几条的描述
+    class Violations {
+    public:
+        void add(const std::string &what) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (++count_ <= 10) messages_.push_back(what);
+        }
+        std::uint64_t count() const {
+            std::lock_guard<std::mutex> lock(mtx_);
+            return count_;
+        }
+        void print(std::ostream &out) const {
+            std::lock_guard<std::mutex> lock(mtx_);
+            for (const auto &message: messages_) out << "violation: " << message << "\n";
+        }
+
+    private:
+        mutable std::mutex mtx_;
+        std::uint64_t count_ = 0;
+        std::vector<std::string> messages_;
+    };
+
+    // 标签形如 "#<key>/<generation>"，key 在整个运行中唯一
+    std::string makeLabel(std::uint64_t key, std::uint64_t generation) {
+        return "#" + std::to_string(key) + "/" + std::to_string(generation);
+    }
+
+    // 把输出喂给虚拟终端，每帧结束时检查被改动的行。调度器在持有全局锁时写出，这里不再加锁
+    class CheckingSink : public pulse::OutputSink {
+    public:
+        explicit CheckingSink(Violations &violations, bool verify) : violations_(violations), verify_(verify) {}
+
+        void write(const char *data, std::size_t size) override {
+            if (verify_) terminal_.feed(std::string_view(data, size));
+        }
+
+        void flush() override {
+            if (!verify_) return;
+            ++frames_;
+            for (int row: terminal_.takeDirtyRows()) checkRow(row);
+        }
+
+        std::uint64_t frames() const { return frames_; }
+        std::uint64_t checkedBars() const { return bars_.size(); }
+        std::uint64_t terminalErrors() const { return terminal_.errors(); }
+
+    private:
+        void checkRow(int row) {
+            std::string line = terminal_.line(row);
+            if (line.empty() || line[0] != '#') return;
+            std::uint64_t key = std::strtoull(line.c_str() + 1, nullptr, 10);
+            // 百分比位于 "|主体|" 之后
+            std::size_t open = line.find('|');
+            std::size_t close = open == std::string::npos ? open : line.find('|', open + 1);
+            if (close == std::string::npos) {
+                violations_.add("row " + std::to_string(row) + " is not a bar: " + line);
+                return;
+            }
+            int percent = std::atoi(line.c_str() + close + 1);
+
+            auto owner = row_owner_.emplace(row, key).first;
+            if (owner->second != key) {
+                violations_.add("row " + std::to_string(row) + " owned by #" + std::to_string(owner->second) +
+                                " shows #" + std::to_string(key));
+            }
+            auto state = bars_.emplace(key, RowState{row, percent}).first;
+            if (state->second.row != row) {
+                violations_.add("#" + std::to_string(key) + " moved from row " + std::to_string(state->second.row) +
+                                " to " + std::to_string(row));
+            }
+            if (percent < state->second.percent) {
+                violations_.add("#" + std::to_string(key) + " went back from " + std::to_string(state->second.percent) +
+                                "% to " + std::to_string(percent) + "%");
+            }
+            state->second.percent = std::max(percent, state->second.percent);
+        }
+
+        struct RowState {
+            int row;
+            int percent;
+        };
+
+        Violations &violations_;
+        bool verify_;
+        pulse::testing::VirtualTerminal terminal_{400};
+        std::unordered_map<int, std::uint64_t> row_owner_;
+        std::unordered_map<std::uint64_t, RowState> bars_;
+        std::uint64_t frames_ = 0;
+    };
+
+    struct Histograms {
+        pulse::LatencyHistogram create;
+        pulse::LatencyHistogram relabel;
+        pulse::LatencyHistogram destroy;
+        pulse::LatencyHistogram update;      // 每 64 次推进采样一次
+        pulse::LatencyHistogram bar_lock_wait;// 每个进度条生命周期内的等锁总时间
+    };
+
+    std::atomic<std::uint64_t> g_next_key{1};
+
+    struct SharedBar {
+        std::uint64_t key;
+        std::unique_ptr<pulse::PulseBar> bar;
+        std::atomic<std::uint64_t> generation{0};
+    };
+
+    // 单个工作线程：依次运行 bars 个自有进度条，其间穿插对共享进度条的推进
+    std::uint64_t runWorker(std::uint64_t seed, std::uint64_t bars, std::uint64_t shared_iters,
+                            std::vector<SharedBar> &shared, Histograms &hist, Violations &violations) {
+        std::mt19937_64 rng(seed);
+        std::vector<std::uint64_t> shared_left(shared.size(), shared_iters);
+        std::uint64_t ops = 0;
+        std::uint64_t sampled = 0;
+
+        auto sharedStep = [&] {
+            std::size_t i = rng() % shared.size();
+            for (std::size_t n = 0; n < shared.size() && shared_left[i] == 0; ++n) i = (i + 1) % shared.size();
+            if (shared_left[i] == 0) return false;
+            --shared_left[i];
+            ++*shared[i].bar;
+            ++ops;
+            return true;
+        };
+
+        for (std::uint64_t b = 0; b < bars; ++b) {
+            const std::uint64_t key = g_next_key.fetch_add(1);
+            const std::uint64_t total = 50 + rng() % 5000;
+            std::uint64_t generation = 0;
+            auto start = Clock::now();
+            auto bar = std::make_unique<pulse::PulseBar>(total, 20, makeLabel(key, generation));
+            hist.create.record(elapsedNs(start));
+            std::uint64_t expected = 0;
+
+            while (expected < total) {
+                unsigned r = static_cast<unsigned>(rng() % 100);
+                if (r < 2) break;// 未完成就销毁
+                if (r < 50) {
+                    std::uint64_t k = std::min<std::uint64_t>(1 + rng() % 64, total - expected);
+                    bool timed = (++sampled & 63) == 0;
+                    auto t = timed ? Clock::now() : Clock::time_point();
+                    if (k == 1) {
+                        ++*bar;
+                    } else {
+                        bar->advance(k);
+                    }
+                    if (timed) hist.update.record(elapsedNs(t));
+                    expected += k;
+                } else if (r < 53) {
+                    expected = std::min(total, expected + 1 + rng() % 16);
+                    bar->update(expected);
+                } else if (r < 80) {
+                    if (!sharedStep()) continue;
+                } else if (r < 83) {
+                    start = Clock::now();
+                    bar->setLabel(makeLabel(key, ++generation));
+                    hist.relabel.record(elapsedNs(start));
+                } else if (r < 84) {
+                    SharedBar &s = shared[rng() % shared.size()];
+                    s.bar->setLabel(makeLabel(s.key, s.generation.fetch_add(1) + 1));
+                } else if (r < 86) {
+                    // 嵌套的子进度条，跑完后销毁
+                    const std::uint64_t child_key = g_next_key.fetch_add(1);
+                    const std::uint64_t child_total = 1 + rng() % 200;
+                    pulse::PulseBar child(child_total, 20, makeLabel(child_key, 0));
+                    child.setParent(*bar);
+                    for (std::uint64_t i = 0; i < child_total; ++i) ++child;
+                    if (child.count() != child_total) violations.add("child #" + std::to_string(child_key) + " lost counts");
+                    if (rng() % 2) child.complete();
+                    ops += child_total + 2;
+                    continue;
+                } else {
+                    ++*bar;
+                    ++expected;
+                }
+                ++ops;
+            }
+
+            if (bar->count() != expected) {
+                violations.add("#" + std::to_string(key) + " counted " + std::to_string(bar->count()) +
+                               ", expected " + std::to_string(expected));
+            }
+            if (rng() % 4) bar->complete();
+            hist.bar_lock_wait.record(bar->stats().lock_wait_ns);
+            start = Clock::now();
+            bar.reset();
+            hist.destroy.record(elapsedNs(start));
+            ops += 2;
+        }
+        while (sharedStep()) {
+        }
+        return ops;
+    }
+
+    void writePercentiles(std::ostream &out, const char *name, const pulse::LatencyHistogram &hist) {
+        pulse::LatencyHistogram::Snapshot snap = hist.snapshot();
+        out << ",\"" << name << "\":{\"count\":" << snap.count
+            << ",\"p50_ns\":" << snap.percentile(50)
+            << ",\"p99_ns\":" << snap.percentile(99)
+            << ",\"p999_ns\":" << snap.percentile(99.9)
+            << ",\"max_ns\":" << snap.percentile(100) << "}";
+    }
+}// namespace
+
+int main(int argc, char **argv) {
+    const auto threads = static_cast<int>(argValue(argc, argv, "--threads", 256));
+    const std::uint64_t bars = argValue(argc, argv, "--bars", 16);
+    const std::uint64_t shared_iters = argValue(argc, argv, "--shared-iters", 256);
+    const std::uint64_t fps = argValue(argc, argv, "--fps", 60);
+    const std::uint64_t seed = argValue(argc, argv, "--seed", 1);
+    const bool verify = argValue(argc, argv, "--verify", 1) != 0;
+
+    Violations violations;
+    CheckingSink sink(violations, verify);
+    pulse::PulseBar::setOutputSink(&sink);
+    pulse::FrameScheduler::instance().setMaxFps(static_cast<double>(fps));
+
+    // 共享进度条：每个线程对每个共享进度条恰好推进 shared_iters 次
+    std::vector<SharedBar> shared(4);
+    const std::uint64_t shared_total = shared_iters * static_cast<std::uint64_t>(threads);
+    for (SharedBar &s: shared) {
+        s.key = g_next_key.fetch_add(1);
+        s.bar = std::make_unique<pulse::PulseBar>(shared_total, 20, makeLabel(s.key, 0));
+    }
+
+    Histograms hist;
+    pulse::OverheadStats before = pulse::stats();
+    std::atomic<std::uint64_t> ops{0};
+    auto start = Clock::now();
+    {
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                ops += runWorker(seed * 7919 + static_cast<std::uint64_t>(t), bars, shared_iters, shared, hist, violations);
+            });
+        }
+        for (auto &worker: workers) worker.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (SharedBar &s: shared) {
+        if (s.bar->count() != shared_total) {
+            violations.add("shared #" + std::to_string(s.key) + " counted " + std::to_string(s.bar->count()) +
+                           ", expected " + std::to_string(shared_total));
+        }
+        s.bar->complete();
+    }
+    shared.clear();
+    pulse::FrameScheduler::instance().flush();
+    pulse::OverheadStats after = pulse::stats();
+    pulse::PulseBar::setOutputSink(nullptr);
+
+    if (sink.terminalErrors() > 0) violations.add(std::to_string(sink.terminalErrors()) + " malformed escape sequences");
+
+    std::cout << "{\"threads\":" << threads
+              << ",\"bars_per_thread\":" << bars
+              << ",\"seconds\":" << seconds
+              << ",\"ops\":" << ops.load()
+              << ",\"ops_per_second\":" << static_cast<double>(ops.load()) / seconds
+              << ",\"frames\":" << after.frames_written - before.frames_written
+              << ",\"checked_frames\":" << sink.frames()
+              << ",\"checked_bars\":" << sink.checkedBars()
+              << ",\"lock_contentions\":" << after.lock_contentions - before.lock_contentions
+              << ",\"lock_wait_ns\":" << after.lock_wait_ns - before.lock_wait_ns;
+    writePercentiles(std::cout, "create", hist.create);
+    writePercentiles(std::cout, "relabel", hist.relabel);
+    writePercentiles(std::cout, "destroy", hist.destroy);
+    writePercentiles(std::cout, "update_sampled", hist.update);
+    writePercentiles(std::cout, "bar_lock_wait", hist.bar_lock_wait);
+    std::cout << ",\"violations\":" << violations.count() << "}\n";
+    violations.print(std::cerr);
+    return violations.count() == 0 ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include "PulseBarAlgorithm.hpp"
+#include "PulseBarTesting.hpp"
+#include "test_framework.hpp"
+
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    struct QuietScreen {
+        VirtualTerminal terminal;
+        ScreenSink sink{terminal};
+
+        QuietScreen() { pulse::PulseBar::setOutputSink(&sink); }
+        ~QuietScreen() { pulse::PulseBar::setOutputSink(nullptr); }
+    };
+}// namespace
+
+PULSE_TEST(for_each_advances_bar_per_chunk) {
+    QuietScreen screen;
+    std::vector<int> items(1000003, 1);
+    pulse::PulseBar::setUpdateCounting(true);
+    pulse::PulseBar bar(items.size(), "for_each");
+    pulse::PulseBar::setUpdateCounting(false);
+    pulse::for_each(std::execution::par, items.begin(), items.end(), [](int &x) { x *= 3; }, bar);
+    CHECK(std::all_of(items.begin(), items.end(), [](int x) { return x == 3; }));
+    CHECK_EQ(bar.count(), items.size());
+    // 按块汇总：推进次数远少于元素数
+    CHECK(bar.stats().update_calls <= 1025);
+    bar.complete();
+}
+
+PULSE_TEST(transform_matches_std_for_every_policy) {
+    QuietScreen screen;
+    std::vector<int> a(50000), b(50000);
+    std::iota(a.begin(), a.end(), 0);
+    std::iota(b.begin(), b.end(), 7);
+    std::vector<long long> expected(a.size());
+    std::transform(a.begin(), a.end(), b.begin(), expected.begin(), [](int x, int y) { return 1LL * x * y; });
+
+    pulse::PulseBar bar(4 * a.size(), "transform");
+    auto run = [&](auto &&policy) {
+        std::vector<long long> out(a.size());
+        auto end = pulse::transform(policy, a.begin(), a.end(), b.begin(), out.begin(), [](int x, int y) { return 1LL * x * y; }, bar);
+        return end == out.end() && out == expected;
+    };
+    CHECK(run(std::execution::seq));
+    CHECK(run(std::execution::par));
+    CHECK(run(std::execution::par_unseq));
+    CHECK(run(std::execution::unseq));
+    CHECK_EQ(bar.count(), 4 * a.size());
+    bar.complete();
+}
+
+PULSE_TEST(transform_reduce_matches_std) {
+    QuietScreen screen;
+    std::vector<int> items(123457);
+    std::iota(items.begin(), items.end(), -1000);
+    auto square = [](int x) { return 1LL * x * x; };
+    long long expected = std::transform_reduce(items.begin(), items.end(), 5LL, std::plus<>(), square);
+
+    pulse::PulseBar bar(3 * items.size(), "reduce");
+    CHECK_EQ(pulse::transform_reduce(std::execution::par, items.begin(), items.end(), 5LL, std::plus<>(), square, bar), expected);
+    std::vector<long long> wide(items.begin(), items.end());
+    CHECK_EQ(pulse::transform_reduce(std::execution::par_unseq, wide.begin(), wide.end(), wide.begin(), 5LL, bar), expected);
+    CHECK_EQ(pulse::reduce(std::execution::par, items.begin(), items.end(), 0LL, bar),
+             std::reduce(items.begin(), items.end(), 0LL));
+    CHECK_EQ(bar.count(), 3 * items.size());
+    bar.complete();
+}
+
+PULSE_TEST(empty_range_leaves_bar_untouched) {
+    QuietScreen screen;
+    std::vector<int> items;
+    pulse::PulseBar bar(10, "empty");
+    pulse::for_each(std::execution::par, items.begin(), items.end(), [](int &) {}, bar);
+    CHECK_EQ(pulse::reduce(std::execution::seq, items.begin(), items.end(), 42, bar), 42);
+    CHECK_EQ(bar.count(), 0u);
+    bar.complete();
+}
@@ -0,0 +1,210 @@
+#include "PulseBar.hpp"
+#include "test_framework.hpp"
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// 统计堆分配次数，只在 AllocationCounter 存活期间计数。
+// 全局 operator new/delete 转发到 malloc/free；glibc 上再替换 malloc/calloc/realloc 与对齐分配，
+// 转发给 __libc_* 实现，直接调用 malloc 的路径（C 库、第三方库）同样计入。
+// 其它 C 库或 sanitizer 构建（其运行时自己接管 malloc）只统计 operator new
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define PULSE_TEST_COUNT_MALLOC 1
+#endif
+
+namespace {
+    std::atomic<bool> g_counting{false};
+    std::atomic<std::uint64_t> g_allocations{0};
+
+    void countAllocation() {
+        if (g_counting.load(std::memory_order_relaxed)) g_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void *countedAlloc(std::size_t size, std::size_t align = 0) {
+#ifndef PULSE_TEST_COUNT_MALLOC
+        countAllocation();
+#endif
+        if (size == 0) size = 1;
+        void *p = align > alignof(std::max_align_t) ? std::aligned_alloc(align, (size + align - 1) / align * align) : std::malloc(size);
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+
+    struct AllocationCounter {
+        AllocationCounter() {
+            g_allocations.store(0);
+            g_counting.store(true);
+        }
+        ~AllocationCounter() { g_counting.store(false); }
+        std::uint64_t count() const { return g_allocations.load(); }
+    };
+
+    // 丢弃输出的输出目标，本身不分配
+    class NullSink : public pulse::OutputSink {
+    public:
+        void write(const char *, std::size_t size) override { bytes_ += size; }
+        void flush() override {}
+
+    private:
+        std::uint64_t bytes_ = 0;
+    };
+
+    // 不限帧率、不限刷新间隔，使每次可见变化都真正构建并写出一帧
+    struct RenderEverything {
+        NullSink sink;
+        RenderEverything() {
+            pulse::PulseBar::setOutputSink(&sink);
+            pulse::FrameScheduler::instance().setMaxFps(0);
+        }
+        ~RenderEverything() {
+            pulse::FrameScheduler::instance().setMaxFps(30);
+            pulse::PulseBar::setOutputSink(nullptr);
+        }
+    };
+
+    std::uint64_t framesBuilt() {
+        pulse::OverheadStats stats = pulse::stats();
+        return stats.frames_built;
+    }
+}// namespace
+
+#ifdef PULSE_TEST_COUNT_MALLOC
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t count, std::size_t size);
+void *__libc_realloc(void *p, std::size_t size);
+void *__libc_memalign(std::size_t align, std::size_t size);
+void __libc_free(void *p);
+
+void *malloc(std::size_t size) {
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+void *calloc(std::size_t count, std::size_t size) {
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *p, std::size_t size) {
+    countAllocation();
+    return __libc_realloc(p, size);
+}
+
+void *aligned_alloc(std::size_t align, std::size_t size) {
+    countAllocation();
+    return __libc_memalign(align, size);
+}
+
+void *memalign(std::size_t align, std::size_t size) {
+    countAllocation();
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **out, std::size_t align, std::size_t size) {
+    if (align < sizeof(void *) || (align & (align - 1)) != 0) return EINVAL;
+    countAllocation();
+    void *p = __libc_memalign(align, size);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void *p) { __libc_free(p); }
+}
+#endif
+
+void *operator new(std::size_t size) { return countedAlloc(size); }
+void *operator new[](std::size_t size) { return countedAlloc(size); }
+void *operator new(std::size_t size, std::align_val_t align) { return countedAlloc(size, static_cast<std::size_t>(align)); }
+void *operator new[](std::size_t size, std::align_val_t align) { return countedAlloc(size, static_cast<std::size_t>(align)); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+// 预热后 update() 与逐帧渲染不分配
+PULSE_TEST(update_and_render_do_not_allocate) {
+    RenderEverything render;
+    pulse::PulseBar bar(10000, 40, "alloc");
+    bar.setMinInterval(0);
+    for (std::uint64_t i = 1; i <= 1000; ++i) bar.update(i);
+
+    std::uint64_t frames_before = framesBuilt();
+    std::uint64_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (std::uint64_t i = 1001; i < 10000; ++i) bar.update(i);
+        allocations = counter.count();
+    }
+    CHECK_EQ(allocations, 0u);
+    CHECK(framesBuilt() - frames_before >= 50);
+    bar.complete();
+}
+
+PULSE_TEST(increment_and_advance_do_not_allocate) {
+    RenderEverything render;
+    pulse::PulseBar bar(200000, 40, "alloc");
+    bar.setMinInterval(0);
+    for (int i = 0; i < 20000; ++i) ++bar;
+
+    std::uint64_t frames_before = framesBuilt();
+    std::uint64_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (int i = 0; i < 80000; ++i) ++bar;
+        for (int i = 0; i < 1000; ++i) bar.advance(100);
+        allocations = counter.count();
+    }
+    CHECK_EQ(allocations, 0u);
+    CHECK(framesBuilt() - frames_before >= 50);
+    bar.complete();
+}
+
+// 带单位缩放、自定义时间格式与延迟分位数的渲染路径同样不分配
+PULSE_TEST(decorated_render_does_not_allocate) {
+    RenderEverything render;
+    pulse::PulseBar bar(1ull << 30, 40, "bytes");
+    bar.setMinInterval(0);
+    bar.setUnit("B", pulse::UnitScale::IEC);
+    bar.setTimeFormat("%S.%3N");
+    bar.enableLatencyTracking();
+    const std::uint64_t step = (1ull << 30) / 10000;
+    for (std::uint64_t i = 1; i <= 1000; ++i) {
+        bar.recordLatency(std::chrono::nanoseconds(1000 + i));
+        bar.update(i * step);
+    }
+
+    std::uint64_t frames_before = framesBuilt();
+    std::uint64_t allocations = 0;
+    {
+        AllocationCounter counter;
+        for (std::uint64_t i = 1001; i < 10000; ++i) {
+            bar.recordLatency(std::chrono::nanoseconds(1000 + i));
+            bar.update(i * step);
+        }
+        allocations = counter.count();
+    }
+    CHECK_EQ(allocations, 0u);
+    CHECK(framesBuilt() - frames_before >= 50);
+    bar.complete();
+}
+
+#ifdef PULSE_TEST_COUNT_MALLOC
+// 计数器本身：直接调用 malloc 同样计入
+PULSE_TEST(malloc_is_counted) {
+    std::uint64_t allocations = 0;
+    {
+        AllocationCounter counter;
+        void *volatile p = std::malloc(32);
+        std::free(p);
+        allocations = counter.count();
+    }
+    CHECK_EQ(allocations, 1u);
+}
+#endif
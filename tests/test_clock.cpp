@@ -0,0 +1,189 @@
+#include "PulseBarTesting.hpp"
+#include "test_framework.hpp"
+#include <cmath>
+#include <future>
+
+using pulse::testing::ManualClock;
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    // 测试期间注入手动时钟，并把输出接到虚拟终端
+    struct ManualTime {
+        ManualClock clock;
+        VirtualTerminal terminal;
+        ScreenSink sink{terminal};
+
+        ManualTime() {
+            pulse::PulseBar::setClock(&clock);
+            pulse::PulseBar::setOutputSink(&sink);
+        }
+        ~ManualTime() {
+            pulse::PulseBar::setOutputSink(nullptr);
+            pulse::PulseBar::setClock(nullptr);
+        }
+    };
+
+    bool near(double value, double expected, double tolerance) {
+        return std::fabs(value - expected) <= tolerance;
+    }
+}// namespace
+
+PULSE_TEST(estimator_converges_on_replayed_rate) {
+    ManualTime time;
+    pulse::PulseBar bar(100000, 20, "rate");
+    std::uint64_t n = 0;
+    // 前 5 秒每项 1ms，之后每项 4ms
+    for (int i = 0; i < 5000; ++i) {
+        time.clock.advance(std::chrono::milliseconds(1));
+        bar.update(++n);
+    }
+    pulse::BarSnapshot fast = bar.snapshot();
+    CHECK(near(fast.rate, 1000.0, 1.0));
+    CHECK(near(fast.eta, (100000.0 - 5000.0) / 1000.0, 0.5));
+    CHECK(near(fast.elapsed, 5.0, 1e-9));
+
+    for (int i = 0; i < 5000; ++i) {
+        time.clock.advance(std::chrono::milliseconds(4));
+        bar.update(++n);
+    }
+    pulse::BarSnapshot slow = bar.snapshot();
+    CHECK(near(slow.rate, 250.0, 5.0));
+    bar.complete();
+}
+
+PULSE_TEST(mininterval_gates_frames) {
+    ManualTime time;
+    pulse::FrameScheduler &scheduler = pulse::FrameScheduler::instance();
+    double fps = scheduler.maxFps();
+    scheduler.setMaxFps(0);
+
+    auto framesFor = [&](double mininterval) {
+        std::uint64_t before = pulse::stats().frames_built;
+        {
+            pulse::PulseBar bar(1000, 1000, "gate");
+            bar.setMinInterval(mininterval);
+            // 10 秒内 1000 次更新，每次都有可见变化
+            for (int i = 1; i <= 1000; ++i) {
+                time.clock.advance(std::chrono::milliseconds(10));
+                bar.update(i);
+            }
+            bar.complete();
+        }
+        scheduler.flush();
+        return pulse::stats().frames_built - before;
+    };
+
+    std::uint64_t gated = framesFor(0.5);
+    std::uint64_t ungated = framesFor(0);
+    scheduler.setMaxFps(fps);
+
+    // 每 0.5 秒一帧，外加首帧与完成帧
+    CHECK(gated >= 19 && gated <= 23);
+    CHECK(ungated >= 900);
+}
+
+PULSE_TEST(stall_detected_after_timeout) {
+    ManualTime time;
+    std::atomic<int> stalls{0};
+    {
+        pulse::PulseBar bar(100, 20, "stall");
+        bar.setStallCallback([&](pulse::PulseBar &, pulse::StallKind kind) {
+            if (kind == pulse::StallKind::NO_PROGRESS) ++stalls;
+        });
+        bar.setStallTimeout(2.0);
+        pulse::FrameScheduler &scheduler = pulse::FrameScheduler::instance();
+        // 节拍由测试手动驱动；后台节拍线程会在锁外回调，与下面的检查竞争
+        scheduler.stopTicker();
+
+        // 看门狗在节拍时观察到进度
+        bar.update(10);
+        scheduler.tick();
+        time.clock.advanceSeconds(1.0);
+        scheduler.tick();
+        CHECK(bar.stallState() == pulse::StallKind::NONE);
+
+        time.clock.advanceSeconds(1.5);
+        scheduler.tick();
+        CHECK(bar.stallState() == pulse::StallKind::NO_PROGRESS);
+        CHECK_EQ(stalls.load(), 1);
+
+        bar.update(20);
+        scheduler.tick();
+        CHECK(bar.stallState() == pulse::StallKind::NONE);
+        bar.complete();
+    }
+    pulse::FrameScheduler::instance().stopTicker();
+}
+
+// 停滞回调在释放全局锁后执行：回调期间其它线程的 update() 不会被阻塞
+PULSE_TEST(stall_callback_runs_outside_lock) {
+    ManualTime time;
+    bool other_progressed = false;
+    std::future<void> done;
+    {
+        pulse::PulseBar other(100, 20, "other");
+        pulse::PulseBar bar(100, 20, "stuck");
+        bar.setStallCallback([&](pulse::PulseBar &, pulse::StallKind) {
+            // 强制更新总是加锁；future 留在回调外，回调持锁时测试失败而不是死锁
+            done = std::async(std::launch::async, [&] { other.update(50, true); });
+            other_progressed = done.wait_for(std::chrono::seconds(2)) == std::future_status::ready;
+        });
+        bar.setStallTimeout(1.0);
+        pulse::FrameScheduler &scheduler = pulse::FrameScheduler::instance();
+        scheduler.stopTicker();
+        scheduler.tick();
+        time.clock.advanceSeconds(1.5);
+        scheduler.tick();
+        CHECK(bar.stallState() == pulse::StallKind::NO_PROGRESS);
+        if (done.valid()) done.wait();
+        bar.complete();
+    }
+    CHECK(other_progressed);
+}
+
+// 切换时钟后帧预算与经过时间换算到新时钟：手动时钟的纪元远早于真实时钟时也照常出帧
+PULSE_TEST(clock_switch_keeps_frames_flowing) {
+    VirtualTerminal terminal;
+    ScreenSink sink(terminal);
+    pulse::PulseBar::setOutputSink(&sink);
+    {
+        pulse::PulseBar warmup(10, 20, "real");
+        warmup.complete();
+    }
+    ManualClock clock;
+    clock.set(ManualClock::time_point(std::chrono::seconds(1)));
+    std::uint64_t frames = 0;
+    {
+        // 在真实时钟下创建，切换后经过时间从切换前接续
+        pulse::PulseBar bar(100, 20, "manual");
+        pulse::PulseBar::setClock(&clock);
+        std::uint64_t before = pulse::stats().frames_written;
+        for (int i = 1; i <= 100; ++i) {
+            clock.advanceSeconds(1.0);
+            bar.update(i);
+        }
+        frames = pulse::stats().frames_written - before;
+        CHECK(near(bar.snapshot().elapsed, 100.0, 0.5));
+        bar.complete();
+    }
+    pulse::PulseBar::setClock(nullptr);
+    pulse::PulseBar::setOutputSink(nullptr);
+    CHECK(frames >= 99);
+}
+
+PULSE_TEST(eta_text_is_deterministic) {
+    ManualTime time;
+    {
+        pulse::PulseBar bar(10000, 20, "eta");
+        bar.setMinInterval(0);
+        for (int i = 1; i <= 5000; ++i) {
+            time.clock.advance(std::chrono::milliseconds(1));
+            bar.update(i);
+        }
+        // 同样的时间序列总是得到逐字节相同的画面
+        CHECK(time.terminal.line(0) == "eta |█████████▆          | 50% ETA: 4s [1000.00it/s]");
+        bar.complete();
+    }
+    CHECK_EQ(time.terminal.errors(), 0u);
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 极简测试框架：PULSE_TEST 注册用例，CHECK 失败时记录位置并继续，CHECK_EQ 额外打印两侧的值
+namespace pulse_test {
+    struct TestCase {
+        const char *name;
+        void (*fn)();
+    };
+
+    inline std::vector<TestCase> &registry() {
+        static std::vector<TestCase> cases;
+        return cases;
+    }
+
+    inline int &failures() {
+        static int count = 0;
+        return count;
+    }
+
+    struct Registrar {
+        Registrar(const char *name, void (*fn)()) { registry().push_back({name, fn}); }
+    };
+
+    inline void fail(const char *file, int line, const std::string &message) {
+        ++failures();
+        std::fprintf(stderr, "%s:%d: FAILED: %s\n", file, line, message.c_str());
+    }
+}// namespace pulse_test
+
+#define PULSE_TEST(name)                                         \
+    static void name();                                          \
+    static pulse_test::Registrar name##_registrar(#name, &name); \
+    static void name()
+
+#define CHECK(cond)                                               \
+    do {                                                          \
+        if (!(cond)) pulse_test::fail(__FILE__, __LINE__, #cond); \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                                     \
+    do {                                                                                   \
+        auto &&check_a = (a);                                                              \
+        auto &&check_b = (b);                                                              \
+        if (!(check_a == check_b)) {                                                       \
+            pulse_test::fail(__FILE__, __LINE__,                                           \
+                             std::string(#a " == " #b " (") + std::to_string(check_a) +    \
+                                     " vs " + std::to_string(check_b) + ")");              \
+        }                                                                                  \
+    } while (0)
@@ -0,0 +1,79 @@
+#include "PulseBar.hpp"
+#include "test_framework.hpp"
+
+#include <filesystem>
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+using pulse::HistoryStore;
+
+namespace {
+    std::string tempHistoryPath(const char *name) {
+        auto path = std::filesystem::temp_directory_path() / name;
+        std::filesystem::remove(path);
+        return path.string();
+    }
+
+    void appendRun(HistoryStore &store, const std::string &key, std::uint64_t total) {
+        float curve[HistoryStore::kCurvePoints];
+        for (std::size_t i = 0; i < HistoryStore::kCurvePoints; ++i) curve[i] = static_cast<float>(i + 1) / HistoryStore::kCurvePoints;
+        store.append(key, total, static_cast<double>(total) + 0.5, curve);
+    }
+}// namespace
+
+// 标签前缀在 UTF-8 码点边界截断
+PULSE_TEST(history_label_truncates_on_code_points) {
+    std::string path = tempHistoryPath("pulsebar_history_label");
+    {
+        HistoryStore store(path);
+        CHECK(store.isOpen());
+        std::string key = "a";
+        for (int i = 0; i < 20; ++i) key += "进";
+        appendRun(store, key, 10);
+        HistoryStore::Record rec{};
+        CHECK(store.find(key, 10, rec));
+        // 39 字节的上限落在第 13 个字中间，只保留 12 个
+        CHECK(std::string(rec.label) == key.substr(0, 1 + 12 * 3));
+    }
+    std::filesystem::remove(path);
+}
+
+#ifndef _WIN32
+// 多个进程共享同一个历史文件时，每条记录完整写入且不丢失
+PULSE_TEST(history_appends_from_several_processes) {
+    constexpr int kProcesses = 4;
+    constexpr int kRuns = 50;
+    std::string path = tempHistoryPath("pulsebar_history_procs");
+    std::vector<pid_t> children;
+    for (int p = 0; p < kProcesses; ++p) {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            HistoryStore store(path);
+            for (int r = 1; r <= kRuns; ++r) appendRun(store, "proc " + std::to_string(p), static_cast<std::uint64_t>(r));
+            ::_exit(store.isOpen() ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    HistoryStore store(path);
+    for (int p = 0; p < kProcesses; ++p) {
+        std::string key = "proc " + std::to_string(p);
+        for (int r = 1; r <= kRuns; ++r) {
+            HistoryStore::Record rec{};
+            bool found = store.find(key, static_cast<std::uint64_t>(r), rec);
+            CHECK(found);
+            if (!found) continue;
+            CHECK_EQ(rec.total, static_cast<std::uint64_t>(r));
+            CHECK(rec.duration == static_cast<double>(r) + 0.5);
+            CHECK(std::string(rec.label) == key);
+        }
+    }
+    std::filesystem::remove(path);
+}
+#endif
@@ -0,0 +1,125 @@
+#include "PulseBarParallel.hpp"
+#include "PulseBarTesting.hpp"
+#include "test_framework.hpp"
+
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    struct QuietScreen {
+        VirtualTerminal terminal;
+        ScreenSink sink{terminal};
+
+        QuietScreen() { pulse::PulseBar::setOutputSink(&sink); }
+        ~QuietScreen() { pulse::PulseBar::setOutputSink(nullptr); }
+    };
+}// namespace
+
+PULSE_TEST(parallel_for_visits_every_index_once) {
+    QuietScreen screen;
+    pulse::WorkStealingPool pool(4);
+    std::vector<std::atomic<int>> hits(100003);
+    pulse::PulseBar bar(hits.size(), "visit");
+    pulse::parallel_for(0, static_cast<int>(hits.size()), 1000, [&](int i) { hits[i].fetch_add(1); }, bar, {&pool});
+    int wrong = 0;
+    for (auto &hit: hits) wrong += hit.load() != 1;
+    CHECK_EQ(wrong, 0);
+    CHECK_EQ(bar.count(), hits.size());
+    bar.complete();
+}
+
+PULSE_TEST(parallel_for_chunk_form_accumulates_into_existing_bar) {
+    QuietScreen screen;
+    pulse::WorkStealingPool pool(3);
+    std::atomic<long long> sum{0};
+    pulse::PulseBar bar(20000, "blocks");
+    auto body = [&](long long lo, long long hi) {
+        long long local = 0;
+        for (long long i = lo; i < hi; ++i) local += i;
+        sum += local;
+    };
+    pulse::parallel_for(0LL, 10000LL, 0, body, bar, {&pool});
+    pulse::parallel_for(10000LL, 20000LL, 777, body, bar, {&pool});
+    CHECK_EQ(sum.load(), 20000LL * 19999 / 2);
+    CHECK_EQ(bar.count(), 20000u);
+    CHECK(!bar.snapshot().completed);
+    bar.complete();
+}
+
+PULSE_TEST(work_stealing_balances_skewed_partitions) {
+    QuietScreen screen;
+    pulse::WorkStealingPool pool(4);
+    std::uint64_t before = pool.steals();
+    std::vector<std::atomic<int>> hits(64);
+    // 第一个分区的每一项都很慢，其余线程应当把它的块偷走
+    pulse::parallel_for(0, 64, 1, [&](int i) {
+        if (i < 16) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        hits[i].fetch_add(1);
+    }, "skewed", {&pool});
+    int wrong = 0;
+    for (auto &hit: hits) wrong += hit.load() != 1;
+    CHECK_EQ(wrong, 0);
+    CHECK(pool.steals() > before);
+}
+
+PULSE_TEST(worker_bars_follow_partitions) {
+    QuietScreen screen;
+    pulse::WorkStealingPool pool(3);
+    pulse::parallel_for(0, 3000, 100, [](int) {}, "pf", {&pool, true});
+    pulse::FrameScheduler::instance().flush();
+    // 总进度条在上，每个分区一行
+    CHECK(screen.terminal.line(0).rfind("pf ", 0) == 0);
+    for (int row = 1; row <= 3; ++row) {
+        CHECK(screen.terminal.line(row).rfind("pf #" + std::to_string(row - 1), 0) == 0);
+    }
+    for (int row = 0; row <= 3; ++row) CHECK(screen.terminal.line(row).find("100%") != std::string::npos);
+}
+
+PULSE_TEST(parallel_for_rethrows_first_exception) {
+    QuietScreen screen;
+    pulse::WorkStealingPool pool(4);
+    std::atomic<int> calls{0};
+    bool thrown = false;
+    try {
+        pulse::parallel_for(0, 100000, 100, [&](int i) {
+            ++calls;
+            if (i == 500) throw std::runtime_error("boom");
+        }, "throws", {&pool});
+    } catch (const std::runtime_error &e) {
+        thrown = std::string(e.what()) == "boom";
+    }
+    CHECK(thrown);
+    // 出错后不再开始新的块
+    CHECK(calls.load() < 100000);
+
+    // 调用方的进度条只计入完整执行过的块：抛出异常的块从 500 开始，其余块要么执行完要么被跳过
+    std::atomic<int> done{0};
+    pulse::PulseBar bar(100000, "owned");
+    try {
+        pulse::parallel_for(0, 100000, 100, [&](int i) {
+            if (i == 500) throw std::runtime_error("boom");
+            ++done;
+        }, bar, {&pool});
+    } catch (const std::runtime_error &) {
+    }
+    CHECK_EQ(bar.count(), static_cast<std::uint64_t>(done.load()));
+    bar.complete();
+
+    // 线程池仍然可用
+    std::atomic<int> after{0};
+    pulse::parallel_for(0, 1000, 10, [&](int) { ++after; }, "after", {&pool});
+    CHECK_EQ(after.load(), 1000);
+}
+
+PULSE_TEST(nested_parallel_for_runs_inline) {
+    QuietScreen screen;
+    pulse::WorkStealingPool pool(2);
+    std::atomic<int> inner{0};
+    pulse::PulseBar bar(64, "inner");
+    pulse::parallel_for(0, 8, 1, [&](int) {
+        pulse::parallel_for(0, 8, 1, [&](int) { ++inner; }, bar, {&pool});
+    }, "outer", {&pool});
+    CHECK_EQ(inner.load(), 64);
+    CHECK_EQ(bar.count(), 64u);
+    bar.complete();
+}
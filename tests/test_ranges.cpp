@@ -0,0 +1,95 @@
+#include "PulseBarRanges.hpp"
+#include "PulseBarTesting.hpp"
+#include "test_framework.hpp"
+#include <list>
+#include <numeric>
+
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    struct QuietScreen {
+        VirtualTerminal terminal;
+        ScreenSink sink{terminal};
+
+        QuietScreen() { pulse::PulseBar::setOutputSink(&sink); }
+        ~QuietScreen() { pulse::PulseBar::setOutputSink(nullptr); }
+    };
+}// namespace
+
+PULSE_TEST(track_sized_range_counts_every_element) {
+    QuietScreen screen;
+    std::vector<int> items(100003);
+    std::iota(items.begin(), items.end(), 0);
+    auto view = pulse::track(items, "sized");
+    static_assert(std::ranges::forward_range<decltype(view)>);
+    static_assert(std::ranges::sized_range<decltype(view)>);
+    CHECK_EQ(view.bar().total(), items.size());
+    long long sum = 0;
+    for (int x: view) sum += x;
+    CHECK_EQ(sum, 100003LL * 100002 / 2);
+    CHECK_EQ(view.bar().count(), items.size());
+    CHECK(view.bar().snapshot().completed);
+}
+
+PULSE_TEST(track_unsized_forward_range_measures_total) {
+    QuietScreen screen;
+    std::list<int> items(1000, 1);
+    auto odd = items | std::views::transform([](int x) { return x * 3; }) | std::views::filter([](int x) { return x % 2; });
+    auto view = pulse::track(odd, "filtered");
+    CHECK_EQ(view.bar().total(), 1000u);
+    int seen = 0;
+    for (int x: view) seen += x == 3;
+    CHECK_EQ(seen, 1000);
+    CHECK_EQ(view.bar().count(), 1000u);
+}
+
+PULSE_TEST(views_track_advances_existing_bar) {
+    QuietScreen screen;
+    std::vector<int> items(5000, 1);
+    pulse::PulseBar bar(10000, 20, "shared");
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int x: items | pulse::views::track(bar, 64)) (void) x;
+    }
+    CHECK_EQ(bar.count(), 10000u);
+    CHECK(!bar.snapshot().completed);// 调用方的进度条不会被自动完成
+
+    std::uint64_t n = 0;
+    for (int x: items | pulse::views::track) n += static_cast<std::uint64_t>(x);
+    CHECK_EQ(n, 5000u);
+    bar.complete();
+}
+
+PULSE_TEST(track_batches_shared_updates) {
+    QuietScreen screen;
+    pulse::PulseBar::setUpdateCounting(true);
+    std::vector<int> items(1 << 20, 1);
+    pulse::PulseBar bar(items.size(), 20, "batched");
+    pulse::PulseBar::setUpdateCounting(false);
+    auto view = items | pulse::views::track(bar);
+    auto it = view.begin();
+    for (int i = 0; i < 1000; ++i) ++it;
+    // 默认批量为总量的 1/4096 即 256 项，只提交了完整的批次
+    CHECK_EQ(bar.count(), 768u);
+    std::ranges::for_each(it, view.end(), [](int) {});
+    CHECK_EQ(bar.count(), items.size());
+    CHECK(bar.stats().update_calls <= 4097);
+    bar.complete();
+}
+
+PULSE_TEST(track_chunks_yields_contiguous_blocks) {
+    QuietScreen screen;
+    std::vector<int> items(10000, 2);
+    auto blocks = pulse::track_chunks(items, 3000, "chunks");
+    CHECK_EQ(blocks.blocks(), 4u);
+    std::vector<std::size_t> sizes;
+    long long sum = 0;
+    for (auto block: blocks) {
+        sizes.push_back(block.size());
+        for (int x: block) sum += x;
+    }
+    CHECK(sizes == std::vector<std::size_t>({3000, 3000, 3000, 1000}));
+    CHECK_EQ(sum, 20000LL);
+    CHECK_EQ(blocks.bar().count(), 10000u);
+    CHECK(blocks.bar().snapshot().completed);
+}
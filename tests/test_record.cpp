@@ -0,0 +1,127 @@
+#include "PulseBarRecord.hpp"
+#include "PulseBarTesting.hpp"
+#include "test_framework.hpp"
+
+using pulse::RecordType;
+using pulse::SessionRecord;
+using pulse::testing::ManualClock;
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    // 在手动时钟下运行一段固定的会话：外层进度条带一个用 advance() 推进的子进度条，中途改标签
+    void runSession(ManualClock &clock) {
+        pulse::PulseBar outer(4, 20, "outer");
+        for (int o = 0; o < 4; ++o) {
+            pulse::PulseBar inner(1000, 20, "inner");
+            inner.setParent(outer);
+            for (int i = 0; i < 1000; i += 10) {
+                clock.advance(std::chrono::milliseconds(1));
+                inner.advance(10);
+            }
+            inner.complete();
+            if (o == 2) outer.setLabel("outer (last)");
+            outer.update(o + 1);
+        }
+        outer.complete();
+    }
+
+    int countType(const std::vector<SessionRecord> &records, RecordType type) {
+        int count = 0;
+        for (const auto &r: records) count += r.type == type;
+        return count;
+    }
+}// namespace
+
+PULSE_TEST(session_round_trip) {
+    ManualClock clock;
+    VirtualTerminal terminal;
+    ScreenSink sink(terminal);
+    pulse::PulseBar::setClock(&clock);
+    pulse::PulseBar::setOutputSink(&sink);
+    std::string file;
+    std::vector<SessionRecord> recorded;
+    {
+        pulse::SessionRecorder recorder;
+        runSession(clock);
+        recorded = recorder.records();
+        std::ostringstream out;
+        recorder.write(out);
+        file = out.str();
+    }
+    pulse::FrameScheduler::instance().stopTicker();
+    pulse::PulseBar::setOutputSink(nullptr);
+    pulse::PulseBar::setClock(nullptr);
+
+    CHECK_EQ(countType(recorded, RecordType::CREATE), 5);
+    CHECK_EQ(countType(recorded, RecordType::DESTROY), 5);
+    CHECK_EQ(countType(recorded, RecordType::COMPLETE), 5);
+    CHECK_EQ(countType(recorded, RecordType::LABEL), 1);
+    CHECK_EQ(countType(recorded, RecordType::ADVANCE), 400);
+    CHECK_EQ(recorded.back().ts_ns, 400000000);
+    // 每次 advance 约 4 字节
+    CHECK(file.size() < 3000);
+
+    std::istringstream in(file);
+    std::vector<SessionRecord> loaded;
+    CHECK(pulse::loadSession(in, loaded));
+    CHECK_EQ(loaded.size(), recorded.size());
+    for (std::size_t i = 0; i < std::min(loaded.size(), recorded.size()); ++i) {
+        CHECK(loaded[i].type == recorded[i].type);
+        CHECK_EQ(loaded[i].ts_ns, recorded[i].ts_ns);
+        CHECK_EQ(loaded[i].bar, recorded[i].bar);
+        CHECK_EQ(loaded[i].value, recorded[i].value);
+        CHECK(loaded[i].label == recorded[i].label);
+    }
+
+    // 截断的文件报告错误
+    std::istringstream truncated(file.substr(0, file.size() - 1));
+    std::vector<SessionRecord> partial;
+    CHECK(!pulse::loadSession(truncated, partial));
+}
+
+PULSE_TEST(replay_reproduces_screen) {
+    ManualClock clock;
+    pulse::PulseBar::setClock(&clock);
+
+    VirtualTerminal original;
+    ScreenSink original_sink(original);
+    pulse::PulseBar::setOutputSink(&original_sink);
+    std::vector<SessionRecord> records;
+    {
+        pulse::SessionRecorder recorder;
+        runSession(clock);
+        records = recorder.records();
+    }
+    pulse::FrameScheduler::instance().stopTicker();
+
+    VirtualTerminal replayed;
+    ScreenSink replayed_sink(replayed);
+    pulse::PulseBar::setOutputSink(&replayed_sink);
+    const auto start = clock.now();
+    std::size_t applied = pulse::replaySession(records, [&](std::chrono::nanoseconds at) { clock.set(start + at); });
+    pulse::PulseBar::setOutputSink(nullptr);
+    pulse::PulseBar::setClock(nullptr);
+
+    CHECK_EQ(applied, records.size());
+    CHECK(replayed.lines() == original.lines());
+    CHECK_EQ(replayed.errors(), 0u);
+}
+
+PULSE_TEST(thread_log_alternating_logs_share_one_buffer) {
+    pulse::detail::ThreadLog first;
+    pulse::detail::ThreadLog second;
+    for (int i = 0; i < 100; ++i) {
+        char byte = static_cast<char>(i);
+        pulse::detail::ThreadLog::commit(first.local(), std::string_view(&byte, 1));
+        pulse::detail::ThreadLog::commit(second.local(), std::string_view(&byte, 1));
+    }
+    CHECK_EQ(first.threads(), std::size_t(1));
+    CHECK_EQ(second.threads(), std::size_t(1));
+    std::string bytes;
+    second.forEachThread([&](const std::vector<std::string_view> &chunks) {
+        for (std::string_view chunk: chunks) bytes += chunk;
+    });
+    CHECK_EQ(bytes.size(), std::size_t(100));
+    CHECK_EQ(static_cast<int>(bytes.back()), 99);
+}
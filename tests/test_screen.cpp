@@ -0,0 +1,252 @@
+#include "PulseBarTesting.hpp"
+#include "test_framework.hpp"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using pulse::testing::ManualClock;
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    // 测试期间把所有进度条输出接到虚拟终端
+    struct ScreenCapture {
+        VirtualTerminal terminal;
+        ScreenSink sink{terminal};
+
+        ScreenCapture() { pulse::PulseBar::setOutputSink(&sink); }
+        ~ScreenCapture() { pulse::PulseBar::setOutputSink(nullptr); }
+    };
+
+    int countContaining(const std::vector<std::string> &lines, const std::string &needle) {
+        int count = 0;
+        for (const auto &line: lines) {
+            if (line.find(needle) != std::string::npos) ++count;
+        }
+        return count;
+    }
+}// namespace
+
+PULSE_TEST(single_bar_final_state) {
+    ScreenCapture screen;
+    {
+        pulse::PulseBar bar(100, 40, "single");
+        for (int i = 0; i <= 100; ++i) bar.update(i);
+        bar.complete();
+    }
+    auto lines = screen.terminal.lines();
+    CHECK_EQ(lines.size(), 1u);
+    CHECK(lines[0].find("single") == 0);
+    CHECK(lines[0].find("100%") != std::string::npos);
+    CHECK_EQ(screen.terminal.errors(), 0u);
+}
+
+PULSE_TEST(sequential_bars_on_own_lines) {
+    ScreenCapture screen;
+    for (int b = 0; b < 3; ++b) {
+        pulse::PulseBar bar(10, 20, "seq " + std::to_string(b));
+        for (int i = 0; i < 10; ++i) ++bar;
+        bar.complete();
+    }
+    auto lines = screen.terminal.lines();
+    CHECK_EQ(lines.size(), 3u);
+    for (int b = 0; b < 3; ++b) {
+        CHECK(lines[b].find("seq " + std::to_string(b)) == 0);
+        CHECK(lines[b].find("100%") != std::string::npos);
+    }
+}
+
+PULSE_TEST(nested_bars_share_block) {
+    ScreenCapture screen;
+    {
+        pulse::PulseBar outer(3, 20, "outer");
+        for (int o = 0; o < 3; ++o) {
+            pulse::PulseBar inner(50, 20, "inner");
+            for (int i = 0; i < 50; ++i) ++inner;
+            inner.complete();
+            ++outer;
+        }
+        outer.complete();
+    }
+    auto lines = screen.terminal.lines();
+    CHECK_EQ(countContaining(lines, "outer"), 1);
+    CHECK_EQ(countContaining(lines, "inner"), 3);
+    CHECK(lines[0].find("outer") == 0);
+    CHECK(lines[0].find("100%") != std::string::npos);
+    CHECK_EQ(screen.terminal.errors(), 0u);
+}
+
+// 宽度为 0 时只显示百分比，不能因填充格阈值除零
+PULSE_TEST(zero_width_bar_updates) {
+    ScreenCapture screen;
+    {
+        pulse::PulseBar bar(100, 0, "w0");
+        for (int i = 0; i <= 100; ++i) bar.update(i);
+        bar.complete();
+    }
+    auto lines = screen.terminal.lines();
+    CHECK_EQ(lines.size(), 1u);
+    CHECK(lines[0].find("w0") == 0);
+    CHECK(lines[0].find("100%") != std::string::npos);
+}
+
+// 被帧预算推迟的最后一帧不依赖后续 update()：进度条空闲后也会补画
+PULSE_TEST(deferred_frame_reaches_sink_when_idle) {
+    // 节拍线程在后台写入，读取虚拟终端前需要与写入同步
+    struct WaitingSink : pulse::OutputSink {
+        VirtualTerminal terminal;
+        std::mutex mtx;
+        std::condition_variable cv;
+
+        void write(const char *data, std::size_t size) override {
+            std::lock_guard<std::mutex> lock(mtx);
+            terminal.feed(std::string_view(data, size));
+            cv.notify_all();
+        }
+    } sink;
+    pulse::PulseBar::setOutputSink(&sink);
+    {
+        pulse::PulseBar a(100, 20, "idle a");
+        pulse::PulseBar b(100, 20, "idle b");
+        a.setMinInterval(0);
+        b.setMinInterval(0);
+        a.update(50);
+        b.update(70);
+        std::unique_lock<std::mutex> lock(sink.mtx);
+        bool shown = sink.cv.wait_for(lock, std::chrono::seconds(2), [&] {
+            auto lines = sink.terminal.lines();
+            return lines.size() == 2 && lines[1].find("70%") != std::string::npos;
+        });
+        CHECK(shown);
+        lock.unlock();
+        a.complete();
+        b.complete();
+    }
+    pulse::PulseBar::setOutputSink(nullptr);
+}
+
+// 每个进度条统计自己写出的行与字节，合计不超过写到输出目标的总量
+PULSE_TEST(per_bar_write_stats) {
+    ScreenCapture screen;
+    std::uint64_t bytes_before = pulse::stats().bytes_written;
+    pulse::BarStats a_stats, b_stats;
+    {
+        pulse::PulseBar a(100, 20, "stats a");
+        pulse::PulseBar b(100, 20, "stats b");
+        a.setMinInterval(0);
+        pulse::FrameScheduler::instance().setMaxFps(0);
+        for (int i = 0; i <= 100; ++i) a.update(i);
+        b.complete();
+        a.complete();
+        pulse::FrameScheduler::instance().setMaxFps(30);
+        a_stats = a.stats();
+        b_stats = b.stats();
+    }
+    CHECK(a_stats.frames_written > b_stats.frames_written);
+    CHECK(b_stats.frames_written >= 1);
+    CHECK(a_stats.frames_written <= a_stats.frames_built);
+    CHECK(b_stats.bytes_written >= std::string("stats b").size() * b_stats.frames_written);
+    CHECK(a_stats.bytes_written + b_stats.bytes_written <= pulse::stats().bytes_written - bytes_before);
+}
+
+// 样式变化不等下一次可见的进度变化，下一次更新就重绘
+PULSE_TEST(label_change_redraws_on_next_update) {
+    ScreenCapture screen;
+    pulse::FrameScheduler::instance().setMaxFps(0);
+    {
+        pulse::PulseBar bar(1000, 20, "before");
+        bar.setMinInterval(0);
+        for (int i = 1; i <= 500; ++i) bar.update(i);
+        bar.setLabel("after");
+        CHECK(screen.terminal.line(0).find("after") == 0);
+        bar.complete();
+    }
+    pulse::FrameScheduler::instance().setMaxFps(30);
+}
+
+// 计数停滞时重复 update() 同一个值，仍要按时间加锁采样并重绘，画面不能停在最后一帧
+PULSE_TEST(stalled_updates_keep_redrawing) {
+    ManualClock clock;
+    pulse::PulseBar::setClock(&clock);
+    ScreenCapture screen;
+    pulse::FrameScheduler::instance().setMaxFps(0);
+    {
+        pulse::PulseBar bar(100, 20, "stalled");
+        bar.setMinInterval(0);
+        for (int i = 1; i <= 10; ++i) {
+            clock.advance(std::chrono::milliseconds(100));
+            bar.update(i);
+        }
+        std::string before = screen.terminal.line(0);
+        std::uint64_t frames = bar.stats().frames_built;
+        for (int i = 0; i < 60; ++i) {
+            clock.advanceSeconds(1.0);
+            bar.update(10);
+        }
+        CHECK(bar.stats().frames_built > frames);
+        CHECK(screen.terminal.line(0) != before);
+        bar.complete();
+    }
+    pulse::FrameScheduler::instance().setMaxFps(30);
+    pulse::PulseBar::setClock(nullptr);
+}
+
+// 多线程各自的进度条不能互相覆盖：每个标签恰好出现在一行，且都停在 100%
+PULSE_TEST(concurrent_bars_keep_distinct_rows) {
+    for (int threads: {1, 2, 4, 8, 16, 32, 64}) {
+        ScreenCapture screen;
+        pulse::FrameScheduler::instance().setMaxFps(0);
+        {
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; ++t) {
+                workers.emplace_back([t] {
+                    pulse::PulseBar bar(200, 20, "worker<" + std::to_string(t) + ">");
+                    bar.setMinInterval(0);
+                    for (int i = 1; i <= 200; ++i) {
+                        bar.update(i);
+                        if (i % 50 == 0) std::this_thread::yield();
+                    }
+                    bar.complete();
+                });
+            }
+            for (auto &worker: workers) worker.join();
+        }
+        pulse::FrameScheduler::instance().setMaxFps(30);
+
+        auto lines = screen.terminal.lines();
+        CHECK_EQ(lines.size(), static_cast<std::size_t>(threads));
+        for (int t = 0; t < threads; ++t) {
+            CHECK_EQ(countContaining(lines, "worker<" + std::to_string(t) + ">"), 1);
+        }
+        for (const auto &line: lines) {
+            CHECK_EQ(countContaining({line}, "worker<"), 1);
+            CHECK(line.find("100%") != std::string::npos);
+        }
+        CHECK_EQ(screen.terminal.errors(), 0u);
+    }
+}
+
+// 每帧输出字节数的上限；渲染改动使其变大时测试失败，确需增加时同步调整
+PULSE_TEST(bytes_per_frame_budget) {
+    constexpr double kMaxBytesPerFrame = 400;
+    constexpr double kMaxEscapeBytesPerFrame = 280;
+
+    ScreenCapture screen;
+    pulse::FrameScheduler::instance().setMaxFps(0);
+    pulse::OverheadStats before = pulse::stats();
+    {
+        pulse::PulseBar bar(1000, 40, "budget");
+        bar.setMinInterval(0);
+        for (int i = 1; i <= 1000; ++i) bar.update(i);
+        bar.complete();
+    }
+    pulse::FrameScheduler::instance().setMaxFps(30);
+    pulse::OverheadStats after = pulse::stats();
+
+    auto frames = static_cast<double>(after.frames_written - before.frames_written);
+    CHECK(frames > 0);
+    double bytes_per_frame = static_cast<double>(screen.terminal.totalBytes()) / frames;
+    double escape_per_frame = static_cast<double>(screen.terminal.escapeBytes()) / frames;
+    CHECK(bytes_per_frame <= kMaxBytesPerFrame);
+    CHECK(escape_per_frame <= kMaxEscapeBytesPerFrame);
+}
@@ -0,0 +1,62 @@
+#include "PulseBarTesting.hpp"
+#include "PulseBarTrace.hpp"
+#include "test_framework.hpp"
+
+#include <sstream>
+
+using pulse::testing::ScreenSink;
+using pulse::testing::VirtualTerminal;
+
+namespace {
+    std::size_t countOf(const std::string &text, const std::string &needle) {
+        std::size_t count = 0;
+        for (std::size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) ++count;
+        return count;
+    }
+}// namespace
+
+// 两个记录器同时存在时各自得到完整的事件，长标签原样保留
+PULSE_TEST(trace_recorders_record_full_labels) {
+    VirtualTerminal terminal;
+    ScreenSink sink(terminal);
+    pulse::PulseBar::setOutputSink(&sink);
+    std::ostringstream first_out, second_out;
+    std::string label;
+    for (int i = 0; i < 20; ++i) label += "进";
+    {
+        pulse::TraceRecorder first;
+        pulse::TraceRecorder second;
+        for (int round = 0; round < 3; ++round) {
+            pulse::PulseBar bar(10, 20, label);
+            bar.complete();
+        }
+        first.write(first_out);
+        second.write(second_out);
+    }
+    pulse::PulseBar::setOutputSink(nullptr);
+
+    for (const std::string &json : {first_out.str(), second_out.str()}) {
+        CHECK(json.find("\"name\":\"" + label + "\"") != std::string::npos);
+        CHECK_EQ(countOf(json, "\"ph\":\"B\""), 3u);
+        CHECK_EQ(countOf(json, "\"ph\":\"E\""), 3u);
+    }
+}
+
+// 记录器挂上之前创建的进度条没有开始切片，完成时不输出孤立的结束事件
+PULSE_TEST(trace_skips_end_without_begin) {
+    VirtualTerminal terminal;
+    ScreenSink sink(terminal);
+    pulse::PulseBar::setOutputSink(&sink);
+    std::ostringstream out;
+    {
+        pulse::PulseBar early(10, 20, "early");
+        pulse::TraceRecorder recorder;
+        pulse::PulseBar late(10, 20, "late");
+        late.complete();
+        early.complete();
+        recorder.write(out);
+    }
+    pulse::PulseBar::setOutputSink(nullptr);
+    CHECK_EQ(countOf(out.str(), "\"ph\":\"B\""), 1u);
+    CHECK_EQ(countOf(out.str(), "\"ph\":\"E\""), 1u);
+}